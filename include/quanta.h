@@ -2,13 +2,37 @@
 #define QUANTA_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include "llvm/IR/Value.h"
 #include "llvm/IR/Function.h" 
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/Support/raw_ostream.h"
 #include <map>
-
-extern bool HasError;
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <iosfwd>
+#include <optional>
+
+// Set by any stage that reports an error (imports are parsed on several threads)
+extern std::atomic<bool> HasError;
+
+// Front-end diagnostics go here: std::cerr, unless this thread is parsing an
+// imported module and buffers its messages for an ordered replay.
+std::ostream &diag();
+// Progress messages ("[Quanta] Importing ..."): std::cout unless redirected
+std::ostream &info();
+// Redirect this thread's diag() / info() (null restores std::cerr /
+// std::cout); each returns the stream it replaces.
+std::ostream *setDiagnosticStream(std::ostream *Diag);
+std::ostream *setInfoStream(std::ostream *Info);
 extern std::map<int, int> BinopPrecedence;
 
 // --- 1. LEXER (Vocabulary) ---
@@ -67,105 +91,340 @@ enum TokenType {
     TOK_ENDSWITH = -48,
     TOK_REPLACE = -49,
     TOK_IN = -50,
+    TOK_CONST = -51,
+
+};
+// --- SYMBOLS ---
+// Every identifier is interned once, and the AST, registries and symbol
+// tables carry its 32-bit ID, so lookups are integer compares.
+using SymbolID = uint32_t;
+SymbolID intern(std::string_view Name);
+const std::string &symbolName(SymbolID ID);
+
+// Pre-interned names (in this order) so codegen can switch on them.
+enum KnownSymbol : SymbolID {
+    SYM_NONE = 0, // "" (e.g. a positional CallArg)
+    SYM_MAIN, SYM_PRINT, SYM_INPUT, SYM_DELAY, SYM_TYPE, SYM_BYTESIZE, SYM_ALL,
+    // List methods
+    SYM_PUSH, SYM_POP, SYM_LEN, SYM_CLEAR,
+    // String methods
+    SYM_UPPER, SYM_LOWER, SYM_REVERSE, SYM_STRIP, SYM_LSTRIP, SYM_RSTRIP,
+    SYM_CAPITALIZE, SYM_TITLE, SYM_ISUPPER, SYM_ISLOWER, SYM_ISALPHA,
+    SYM_ISDIGIT, SYM_ISSPACE, SYM_ISALNUM, SYM_FIND, SYM_COUNT,
+    SYM_STARTSWITH, SYM_ENDSWITH, SYM_REPLACE,
+    SYM_FIRST_USER
+};
+
+// Variables visible at the current point of a function, for codegen and
+// the interpreter alike. Each '{ }' block (and a 'loop c in s' variable)
+// opens a scope; names declared in it shadow outer ones and are gone when
+// it closes. Only the innermost binding of a name is kept in the map, so a
+// lookup is one hash probe whatever the depth; closing a scope puts back
+// the bindings it shadowed.
+template <typename T> class ScopedSymbolTable {
+    struct Binding {
+        T Value;
+        unsigned Depth; // Scope that declared it
+    };
+    struct Shadowed {
+        SymbolID Name;
+        std::optional<Binding> Outer; // None if the name was not visible
+    };
+    llvm::DenseMap<SymbolID, Binding> Visible;
+    std::vector<Shadowed> Undo;
+    std::vector<size_t> Scopes; // Undo size when each open scope began
 
-};
-#include <set>
-extern std::set<std::string> LoadedModules;
+public:
+    class Scope {
+        ScopedSymbolTable &Table;
+    public:
+        explicit Scope(ScopedSymbolTable &Table) : Table(Table) { Table.pushScope(); }
+        ~Scope() { Table.popScope(); }
+    };
+
+    // Forget everything: a new function starts at depth 0
+    void clear() {
+        Visible.clear();
+        Undo.clear();
+        Scopes.clear();
+    }
+
+    void pushScope() { Scopes.push_back(Undo.size()); }
+    void popScope() {
+        for (size_t i = Undo.size(); i > Scopes.back(); i--) {
+            Shadowed &S = Undo[i - 1];
+            if (S.Outer) Visible[S.Name] = *S.Outer;
+            else Visible.erase(S.Name);
+        }
+        Undo.resize(Scopes.back());
+        Scopes.pop_back();
+    }
+
+    T *lookup(SymbolID Name) {
+        auto It = Visible.find(Name);
+        return It == Visible.end() ? nullptr : &It->second.Value;
+    }
+    // Only a name declared in the innermost scope, which declaring it again
+    // replaces rather than shadows
+    T *lookupCurrent(SymbolID Name) {
+        auto It = Visible.find(Name);
+        return It == Visible.end() || It->second.Depth != Scopes.size() ? nullptr : &It->second.Value;
+    }
+
+    void declare(SymbolID Name, const T &Value) {
+        unsigned Depth = Scopes.size();
+        auto [It, Fresh] = Visible.try_emplace(Name, Binding{Value, Depth});
+        if (Fresh) {
+            if (Depth) Undo.push_back({Name, std::nullopt});
+            return;
+        }
+        if (It->second.Depth != Depth) Undo.push_back({Name, It->second});
+        It->second = {Value, Depth};
+    }
+
+    // Names of the outermost scope: what is still visible at the end of a
+    // function body
+    template <typename Fn> void forEachOutermost(Fn F) {
+        for (auto &[Name, B] : Visible)
+            if (B.Depth == 0) F(Name, B.Value);
+    }
+};
+
+extern std::unordered_set<SymbolID> LoadedModules; // Module names
 extern std::string RootDir;
+extern std::string RuntimeSource; // quanta_lib.c, or its object once a server has built it
 
+// Compact token: 'value' is a view into the source buffer (or a static
+// spelling for operators), so the buffer must outlive the token vector.
 struct Token {
     int type;
-    std::string value;
     int line;
+    std::string_view value;
 };
 
-std::vector<Token> tokenize(std::string source);
+// Pull-based lexer: each next() call scans just far enough to produce one
+// token, so the parser never needs the whole token stream in memory.
+class Lexer {
+    std::string_view Source;
+    size_t Pos = 0;
+    int Line = 1; // Start counting lines at 1
+    bool Quiet = false;
+    std::ostream &report(); // diag(), or nowhere while Quiet
+public:
+    explicit Lexer(std::string_view source, int firstLine = 1) : Source(source), Line(firstLine) {}
+    Token next();
+    std::string_view getSource() const { return Source; }
+    // Just past the last token returned, and the line there
+    size_t getOffset() const { return Pos; }
+    int getLine() const { return Line; }
+
+    // For passes that only skim the text and lex it again later (import
+    // scanning, skipping function bodies): errors are left to the real pass.
+    void setQuiet(bool Q) { Quiet = Q; }
+};
+
+std::vector<Token> tokenize(std::string_view source);
 
 // --- 2. AST (The Shapes) ---
 
+// Every concrete node class, as X(Kind, Class). Keeps the kind enum and
+// ASTVisitor's dispatch in sync.
+#define QUANTA_AST_NODES(X) \
+    X(Number, NumberAST) \
+    X(Float, FloatAST) \
+    X(Bool, BoolAST) \
+    X(Char, CharAST) \
+    X(String, StringAST) \
+    X(Variable, VariableAST) \
+    X(Assignment, AssignmentAST) \
+    X(VarDecl, VarDeclAST) \
+    X(BinaryExpr, BinaryExprAST) \
+    X(Print, PrintAST) \
+    X(ByteSize, ByteSizeAST) \
+    X(UpdateExpr, UpdateExprAST) \
+    X(Block, BlockAST) \
+    X(Call, CallAST) \
+    X(Loop, LoopAST) \
+    X(LoopOverString, LoopOverStringAST) \
+    X(StringIndex, StringIndexAST) \
+    X(StringSlice, StringSliceAST) \
+    X(IfExpr, IfExprAST) \
+    X(Return, ReturnAST) \
+    X(FixedStringDecl, FixedStringDeclAST) \
+    X(ArrayExpr, ArrayExprAST) \
+    X(FixedArrayDecl, FixedArrayDeclAST) \
+    X(DynamicListDecl, DynamicListDeclAST) \
+    X(IndexAssign, IndexAssignAST) \
+    X(MethodCall, MethodCallAST) \
+    X(Typeof, TypeofAST) \
+    X(Function, FunctionAST)
+
+enum NodeKind {
+#define QUANTA_NODE_KIND(Kind, Class) NK_##Kind,
+    QUANTA_AST_NODES(QUANTA_NODE_KIND)
+#undef QUANTA_NODE_KIND
+};
+
+// --- TYPES ---
+// The type of a value as codegen stores it, so integers go by width: an
+// int is 32 bits (64 for a literal), char 8, and bool is 1 bit as an
+// expression but 8 in a variable. Arrays and lists keep their element's
+// kind and width.
+struct QType {
+    enum KindTy : uint8_t { Unknown, Void, Int, Float, String, Array, List };
+    KindTy Kind = Unknown;
+    KindTy Elem = Unknown; // Array and List
+    uint16_t Bits = 0;     // Int and Float; the element's for Array and List
+
+    static QType integer(unsigned Bits) { return {Int, Unknown, (uint16_t)Bits}; }
+    static QType floating(unsigned Bits) { return {Float, Unknown, (uint16_t)Bits}; }
+    static QType string() { return {String}; }
+    static QType container(KindTy Kind, QType Element) { return {Kind, Element.Kind, Element.Bits}; }
+
+    bool isNumber() const { return Kind == Int || Kind == Float; }
+    QType element() const { return {Elem, Unknown, Bits}; }
+    bool operator==(const QType &O) const { return Kind == O.Kind && Elem == O.Elem && Bits == O.Bits; }
+    bool operator!=(const QType &O) const { return !(*this == O); }
+};
+
+// Nodes carry their kind, so passes test it with llvm::isa<> / dyn_cast<>
+// (each class provides classof()) instead of RTTI.
+// Nodes are never deleted through an ASTNode pointer: the arena that made
+// them destroys them with their real type, so the destructor is not virtual
+// and nodes holding only pointers and scalars need no destructor at all.
 class ASTNode {
+    const NodeKind Kind;
 public:
-    virtual ~ASTNode() = default;
+    QType Ty; // Set by annotateTypes(); fits in the padding after Kind
+    explicit ASTNode(NodeKind K) : Kind(K) {}
+    NodeKind getKind() const { return Kind; }
     virtual llvm::Value *codegen() = 0; 
+protected:
+    ~ASTNode() = default;
 };
 
+// --- AST ARENA ---
+// Every node of a compilation is bump-allocated here and released in one
+// shot. Children are plain pointers into the arena; nothing owns anything.
+class ASTArena {
+    llvm::BumpPtrAllocator Alloc;
+    // Only nodes with strings or vectors inside need their destructor run
+    std::vector<std::pair<void*, void (*)(void*)>> Destructors;
+public:
+    ASTArena() = default;
+    ASTArena(const ASTArena&) = delete;
+    ASTArena &operator=(const ASTArena&) = delete;
+    ~ASTArena() {
+        for (auto &D : Destructors) D.second(D.first);
+    }
+
+    template <typename T, typename... Args>
+    T *make(Args&&... args) {
+        T *Node = new (Alloc.Allocate<T>()) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value)
+            Destructors.push_back({Node, [](void *P) { static_cast<T*>(P)->~T(); }});
+        return Node;
+    }
+};
+
+// The arena this thread is parsing into (one per parse task, see parse())
+extern thread_local ASTArena *CurrentArena;
+
+template <typename T, typename... Args>
+T *makeNode(Args&&... args) {
+    return CurrentArena->make<T>(std::forward<Args>(args)...);
+}
+
 // [IMPORTANT] Forward Declaration
 class FunctionAST;
 
 // [IMPORTANT] Container for the whole program (Functions + Main)
 struct ProgramAST {
-    std::vector<std::unique_ptr<FunctionAST>> functions;
+    std::vector<std::unique_ptr<ASTArena>> Arenas; // Own every node below
+    std::vector<FunctionAST*> functions;
 };
 
 // --- Expression Classes ---
 
 class NumberAST : public ASTNode {
-    int64_t Val; 
 public:
-    NumberAST(int64_t Val) : Val(Val) {
+    int64_t Val; 
+    unsigned Bits; // 64 as written; folded values keep their operation's width
+    NumberAST(int64_t Val, unsigned Bits = 64) : ASTNode(NK_Number), Val(Val), Bits(Bits) {
       
     } 
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Number; }
     llvm::Value *codegen() override;
 };
 
 class FloatAST : public ASTNode {
 public:
     double Val;
-    FloatAST(double val) : Val(val) {}
+    FloatAST(double val) : ASTNode(NK_Float), Val(val) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Float; }
     llvm::Value *codegen() override;
 };
 
 class BoolAST : public ASTNode {
 public:
     bool Val;
-    BoolAST(bool val) : Val(val) {}
+    BoolAST(bool val) : ASTNode(NK_Bool), Val(val) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Bool; }
     llvm::Value *codegen() override;
 };
 
 class CharAST : public ASTNode {
 public:
     char Val;
-    CharAST(char val) : Val(val) {}
+    CharAST(char val) : ASTNode(NK_Char), Val(val) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Char; }
     llvm::Value *codegen() override;
 };
 
 struct StringAST : public ASTNode {
     std::string val;
-    StringAST(std::string v) : val(v) {}
+    StringAST(std::string v) : ASTNode(NK_String), val(v) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_String; }
     llvm::Value *codegen() override;
 };
 
 class VariableAST : public ASTNode {
 public:
-    std::string Name;
-    VariableAST(const std::string &name) : Name(name) {}
+    SymbolID Name;
+    VariableAST(SymbolID name) : ASTNode(NK_Variable), Name(name) {}
     
     // --- ADD THIS LINE ---
-    const std::string &getName() const { return Name; }
+    SymbolID getName() const { return Name; }
     // ---------------------
 
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Variable; }
+
     llvm::Value *codegen() override;
 };
 
 class AssignmentAST : public ASTNode {
-    std::string Name;
-    std::unique_ptr<ASTNode> RHS;
 public:
-    AssignmentAST(const std::string &Name, std::unique_ptr<ASTNode> RHS)
-        : Name(Name), RHS(std::move(RHS)) {}
+    SymbolID Name;
+    ASTNode *RHS;
+    AssignmentAST(SymbolID Name, ASTNode *RHS)
+        : ASTNode(NK_Assignment), Name(Name), RHS(RHS) {}
+
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Assignment; }
 
     llvm::Value *codegen() override;
 };
 
 class VarDeclAST : public ASTNode {
 public:
-    std::string Name;
+    SymbolID Name;
     std::string Type; 
     int Bytes;        
-    std::unique_ptr<ASTNode> InitVal;
+    ASTNode *InitVal;
     
-    VarDeclAST(const std::string &name, const std::string &type, int bytes, std::unique_ptr<ASTNode> init)
-        : Name(name), Type(type), Bytes(bytes), InitVal(std::move(init)) {}
+    VarDeclAST(SymbolID name, const std::string &type, int bytes, ASTNode *init)
+        : ASTNode(NK_VarDecl), Name(name), Type(type), Bytes(bytes), InitVal(init) {}
+        
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_VarDecl; }
         
     llvm::Value *codegen() override;
 };
@@ -173,48 +432,55 @@ public:
 class BinaryExprAST : public ASTNode {
 public:
     char Op;
-    std::unique_ptr<ASTNode> LHS, RHS;
-    BinaryExprAST(char op, std::unique_ptr<ASTNode> LHS, std::unique_ptr<ASTNode> RHS)
-        : Op(op), LHS(std::move(LHS)), RHS(std::move(RHS)) {}
+    ASTNode *LHS, *RHS;
+    BinaryExprAST(char op, ASTNode *LHS, ASTNode *RHS)
+        : ASTNode(NK_BinaryExpr), Op(op), LHS(LHS), RHS(RHS) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_BinaryExpr; }
     llvm::Value *codegen() override;
 };
 class PrintAST : public ASTNode {
 public:
     // OLD: std::unique_ptr<ASTNode> Expr;
     // NEW: Store a list of arguments
-    std::vector<std::unique_ptr<ASTNode>> Args;
+    std::vector<ASTNode*> Args;
 
     // Update Constructor to take a vector
-    PrintAST(std::vector<std::unique_ptr<ASTNode>> args) 
-        : Args(std::move(args)) {}
+    PrintAST(std::vector<ASTNode*> args) 
+        : ASTNode(NK_Print), Args(std::move(args)) {}
+
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Print; }
 
     llvm::Value *codegen() override;
 };
 
 class ByteSizeAST : public ASTNode {
-    std::string Name;
 public:
-    ByteSizeAST(const std::string &Name) : Name(Name) {}
+    SymbolID Name;
+    ByteSizeAST(SymbolID Name) : ASTNode(NK_ByteSize), Name(Name) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_ByteSize; }
     llvm::Value *codegen() override;
 };
 
 class UpdateExprAST : public ASTNode {
-    std::string Name;
+public:
+    SymbolID Name;
     bool IsIncrement; 
     bool IsPrefix;    
 
-public:
-    UpdateExprAST(const std::string &name, bool isIncrement, bool isPrefix)
-        : Name(name), IsIncrement(isIncrement), IsPrefix(isPrefix) {}
+    UpdateExprAST(SymbolID name, bool isIncrement, bool isPrefix)
+        : ASTNode(NK_UpdateExpr), Name(name), IsIncrement(isIncrement), IsPrefix(isPrefix) {}
+
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_UpdateExpr; }
 
     llvm::Value *codegen() override;
 };
 
 class BlockAST : public ASTNode {
-    std::vector<std::unique_ptr<ASTNode>> Statements;
 public:
-    BlockAST(std::vector<std::unique_ptr<ASTNode>> Statements)
-        : Statements(std::move(Statements)) {}
+    std::vector<ASTNode*> Statements;
+    BlockAST(std::vector<ASTNode*> Statements)
+        : ASTNode(NK_Block), Statements(std::move(Statements)) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Block; }
     llvm::Value *codegen() override;
 };
 // Shape: "add(1, 2)"
@@ -230,179 +496,201 @@ public:
 // };
 
 struct CallArg {
-    std::string Name;             // Stores "rollno" (or empty "" if positional)
-    std::shared_ptr<ASTNode> Val; // The value (e.g., 20)
+    SymbolID Name;                // Stores "rollno" (or SYM_NONE if positional)
+    ASTNode *Val; // The value (e.g., 20)
 };
 
 // 2. Update CallAST to hold a vector of CallArg
 class CallAST : public ASTNode {
-    std::string Callee;
+public:
+    SymbolID Callee;
     std::vector<CallArg> Args;
 
-public:
-    CallAST(const std::string &Callee, std::vector<CallArg> Args)
-        : Callee(Callee), Args(std::move(Args)) {}
+    CallAST(SymbolID Callee, std::vector<CallArg> Args)
+        : ASTNode(NK_Call), Callee(Callee), Args(std::move(Args)) {}
+
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Call; }
 
     llvm::Value *codegen() override;
 };
 
 class LoopAST : public ASTNode {
-    std::unique_ptr<ASTNode> Cond;
-    std::unique_ptr<ASTNode> Body;
-
 public:
-    LoopAST(std::unique_ptr<ASTNode> cond, std::unique_ptr<ASTNode> body)
-        : Cond(std::move(cond)), Body(std::move(body)) {}
+    ASTNode *Cond;
+    ASTNode *Body;
+
+    LoopAST(ASTNode *cond, ASTNode *body)
+        : ASTNode(NK_Loop), Cond(cond), Body(body) {}
+
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Loop; }
 
     llvm::Value *codegen() override;
 };
 
 // loop i in string { body } -- i is index (int), stack-only
 class LoopOverStringAST : public ASTNode {
-    std::string VarName;
-    std::unique_ptr<ASTNode> StringExpr;
-    std::unique_ptr<ASTNode> Body;
-
 public:
-    LoopOverStringAST(std::string varName, std::unique_ptr<ASTNode> stringExpr, std::unique_ptr<ASTNode> body)
-        : VarName(std::move(varName)), StringExpr(std::move(stringExpr)), Body(std::move(body)) {}
+    SymbolID VarName;
+    ASTNode *StringExpr;
+    ASTNode *Body;
+
+    LoopOverStringAST(SymbolID varName, ASTNode *stringExpr, ASTNode *body)
+        : ASTNode(NK_LoopOverString), VarName(varName), StringExpr(stringExpr), Body(body) {}
+
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_LoopOverString; }
 
     llvm::Value *codegen() override;
 };
 
 // s[i] -> returns char (i8), stack-only load
 class StringIndexAST : public ASTNode {
-    std::unique_ptr<ASTNode> BaseExpr;
-    std::unique_ptr<ASTNode> IndexExpr;
-
 public:
-    StringIndexAST(std::unique_ptr<ASTNode> base, std::unique_ptr<ASTNode> index)
-        : BaseExpr(std::move(base)), IndexExpr(std::move(index)) {}
+    ASTNode *BaseExpr;
+    ASTNode *IndexExpr;
+
+    StringIndexAST(ASTNode *base, ASTNode *index)
+        : ASTNode(NK_StringIndex), BaseExpr(base), IndexExpr(index) {}
+
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_StringIndex; }
 
     llvm::Value *codegen() override;
 };
 
 // s[start:end] or s[start:end:step] -> new string (heap, one allocation)
 class StringSliceAST : public ASTNode {
-    std::unique_ptr<ASTNode> BaseExpr;
-    std::unique_ptr<ASTNode> StartExpr;
-    std::unique_ptr<ASTNode> EndExpr;
-    std::unique_ptr<ASTNode> StepExpr;  // optional; null = 1
-
 public:
-    StringSliceAST(std::unique_ptr<ASTNode> base, std::unique_ptr<ASTNode> start, std::unique_ptr<ASTNode> end, std::unique_ptr<ASTNode> step)
-        : BaseExpr(std::move(base)), StartExpr(std::move(start)), EndExpr(std::move(end)), StepExpr(std::move(step)) {}
+    ASTNode *BaseExpr;
+    ASTNode *StartExpr;
+    ASTNode *EndExpr;
+    ASTNode *StepExpr;  // optional; null = 1
+
+    StringSliceAST(ASTNode *base, ASTNode *start, ASTNode *end, ASTNode *step)
+        : ASTNode(NK_StringSlice), BaseExpr(base), StartExpr(start), EndExpr(end), StepExpr(step) {}
+
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_StringSlice; }
 
     llvm::Value *codegen() override;
 };
 
 class IfExprAST : public ASTNode {
-    std::unique_ptr<ASTNode> Cond;
-    std::unique_ptr<ASTNode> Then;
-    std::unique_ptr<ASTNode> Else;
 public:
-    IfExprAST(std::unique_ptr<ASTNode> Cond, std::unique_ptr<ASTNode> Then,
-              std::unique_ptr<ASTNode> Else)
-        : Cond(std::move(Cond)), Then(std::move(Then)), Else(std::move(Else)) {}
+    ASTNode *Cond;
+    ASTNode *Then;
+    ASTNode *Else;
+    IfExprAST(ASTNode *Cond, ASTNode *Then,
+              ASTNode *Else)
+        : ASTNode(NK_IfExpr), Cond(Cond), Then(Then), Else(Else) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_IfExpr; }
     llvm::Value *codegen() override;
 };
 
 // String operations have been moved to MethodCallAST
 class ReturnAST : public ASTNode {
-    std::unique_ptr<ASTNode> Expr;
+public:
+    ASTNode *Expr;
     int Line;
 
-public:
-    ReturnAST(std::unique_ptr<ASTNode> Expr, int Line) 
-        : Expr(std::move(Expr)),Line(Line) {}
+    ReturnAST(ASTNode *Expr, int Line) 
+        : ASTNode(NK_Return), Expr(Expr),Line(Line) {}
+
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Return; }
 
     llvm::Value *codegen() override;
 };
 
 class FixedStringDeclAST : public ASTNode {
-    std::string VarName;
+public:
+    SymbolID VarName;
     int Capacity; 
-    std::unique_ptr<ASTNode> InitValue;
+    ASTNode *InitValue;
 
-public:
-    FixedStringDeclAST(std::string varName, int capacity, std::unique_ptr<ASTNode> initValue)
-        : VarName(varName), Capacity(capacity), InitValue(std::move(initValue)) {}
+    FixedStringDeclAST(SymbolID varName, int capacity, ASTNode *initValue)
+        : ASTNode(NK_FixedStringDecl), VarName(varName), Capacity(capacity), InitValue(initValue) {}
+
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_FixedStringDecl; }
 
     llvm::Value *codegen() override;
 };
 
 class ArrayExprAST : public ASTNode {
 public:
-    std::vector<std::unique_ptr<ASTNode>> Elements;
-    ArrayExprAST(std::vector<std::unique_ptr<ASTNode>> Elements) 
-        : Elements(std::move(Elements)) {}
+    std::vector<ASTNode*> Elements;
+    ArrayExprAST(std::vector<ASTNode*> Elements) 
+        : ASTNode(NK_ArrayExpr), Elements(std::move(Elements)) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_ArrayExpr; }
     llvm::Value *codegen() override;
 };
 
 class FixedArrayDeclAST : public ASTNode {
 public:
-    std::string VarName;
+    SymbolID VarName;
     std::string TypeName;
     int Size;
-    std::unique_ptr<ASTNode> InitValue;
-    FixedArrayDeclAST(std::string varName, std::string typeName, int size, std::unique_ptr<ASTNode> initValue)
-        : VarName(varName), TypeName(typeName), Size(size), InitValue(std::move(initValue)) {}
+    ASTNode *InitValue;
+    FixedArrayDeclAST(SymbolID varName, std::string typeName, int size, ASTNode *initValue)
+        : ASTNode(NK_FixedArrayDecl), VarName(varName), TypeName(typeName), Size(size), InitValue(initValue) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_FixedArrayDecl; }
     llvm::Value *codegen() override;
 };
 
 class DynamicListDeclAST : public ASTNode {
 public:
-    std::string VarName;
+    SymbolID VarName;
     std::string TypeName;
-    std::unique_ptr<ASTNode> InitValue;
-    DynamicListDeclAST(std::string varName, std::string typeName, std::unique_ptr<ASTNode> initValue)
-        : VarName(varName), TypeName(typeName), InitValue(std::move(initValue)) {}
+    ASTNode *InitValue;
+    DynamicListDeclAST(SymbolID varName, std::string typeName, ASTNode *initValue)
+        : ASTNode(NK_DynamicListDecl), VarName(varName), TypeName(typeName), InitValue(initValue) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_DynamicListDecl; }
     llvm::Value *codegen() override;
 };
 
 class IndexAssignAST : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> Obj;
-    std::unique_ptr<ASTNode> Index;
-    std::unique_ptr<ASTNode> Value;
-    IndexAssignAST(std::unique_ptr<ASTNode> obj, std::unique_ptr<ASTNode> index, std::unique_ptr<ASTNode> value)
-        : Obj(std::move(obj)), Index(std::move(index)), Value(std::move(value)) {}
+    ASTNode *Obj;
+    ASTNode *Index;
+    ASTNode *Value;
+    IndexAssignAST(ASTNode *obj, ASTNode *index, ASTNode *value)
+        : ASTNode(NK_IndexAssign), Obj(obj), Index(index), Value(value) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_IndexAssign; }
     llvm::Value *codegen() override;
 };
 
 class MethodCallAST : public ASTNode {
 public:
-    std::unique_ptr<ASTNode> Obj;
-    std::string MethodName;
-    std::vector<std::unique_ptr<ASTNode>> Args;
-    MethodCallAST(std::unique_ptr<ASTNode> obj, std::string methodName, std::vector<std::unique_ptr<ASTNode>> args)
-        : Obj(std::move(obj)), MethodName(methodName), Args(std::move(args)) {}
+    ASTNode *Obj;
+    SymbolID MethodName;
+    std::vector<ASTNode*> Args;
+    MethodCallAST(ASTNode *obj, SymbolID methodName, std::vector<ASTNode*> args)
+        : ASTNode(NK_MethodCall), Obj(obj), MethodName(methodName), Args(std::move(args)) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_MethodCall; }
     llvm::Value *codegen() override;
 };
 
 class TypeofAST : public ASTNode {
-    std::string Name;
 public:
-    TypeofAST(const std::string &Name) : Name(Name) {}
+    SymbolID Name;
+    TypeofAST(SymbolID Name) : ASTNode(NK_Typeof), Name(Name) {}
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Typeof; }
     llvm::Value *codegen() override;
 };
 
 struct ArgInfo {
-    std::string Name;
+    SymbolID Name;
     std::string Type;
-    std::shared_ptr<ASTNode> DefaultValue;
+    ASTNode *DefaultValue;
 };
 
 struct FunctionInfo {
-    std::string Name;
+    SymbolID Name;
     std::vector<ArgInfo> Args;
+    FunctionAST *Decl = nullptr; // Signature, to declare the function before its body is emitted
 };
-extern std::map<std::string, FunctionInfo> FunctionRegistry;
+extern std::unordered_map<SymbolID, FunctionInfo> FunctionRegistry;
 
 // 1. Define the Argument Structure
 struct FuncArg {
     std::string Type;
-    std::string Name;
+    SymbolID Name;
     // You can add 'std::unique_ptr<ASTNode> DefaultValue' here later if needed
 };
 
@@ -412,27 +700,227 @@ struct FuncArg {
 class FunctionAST : public ASTNode {
 public:
     std::string ReturnType; 
-    std::string Name;      
+    SymbolID Name;      
     std::vector<FuncArg> Args; // Now uses the struct
-    std::vector<std::unique_ptr<ASTNode>> Body; 
+    std::vector<ASTNode*> Body; 
+    bool IsConst = false; // Calls with literal arguments are evaluated by the compiler
     
     FunctionAST(const std::string& type, 
-                const std::string& name, 
+                SymbolID name, 
                 std::vector<FuncArg> args, // Matches the struct vector
-                std::vector<std::unique_ptr<ASTNode>> body)
-        : ReturnType(type), Name(name), Args(std::move(args)), Body(std::move(body)) {}
+                std::vector<ASTNode*> body)
+        : ASTNode(NK_Function), ReturnType(type), Name(name), Args(std::move(args)), Body(std::move(body)) {}
         
     // Helper to get the function name easily
-    const std::string& getName() const { return Name; }
+    SymbolID getName() const { return Name; }
+        
+    static bool classof(const ASTNode *N) { return N->getKind() == NK_Function; }
         
     llvm::Function *codegen() override;
+    // Declares the function, or returns its existing body-less declaration
+    llvm::Function *codegenPrototype();
 };
+
+// --- AST WALKING ---
+// Calls Fn on every non-null child slot of N, in source order. Slots are
+// passed by reference so a pass can replace a child in place.
+void forEachChild(ASTNode *N, llvm::function_ref<void(ASTNode *&)> Fn);
+
+// Dispatches on the node kind: visit(N) calls Derived::visitCall(CallAST*),
+// visitIfExpr(IfExprAST*), ... Anything not overridden falls back to
+// visitNode(), which by default just walks into the children.
+template <typename Derived, typename RetTy = void>
+class ASTVisitor {
+    Derived &self() { return *static_cast<Derived*>(this); }
+public:
+    RetTy visit(ASTNode *N) {
+        switch (N->getKind()) {
+#define QUANTA_VISIT_CASE(Kind, Class) \
+        case NK_##Kind: return self().visit##Kind(llvm::cast<Class>(N));
+        QUANTA_AST_NODES(QUANTA_VISIT_CASE)
+#undef QUANTA_VISIT_CASE
+        }
+        llvm_unreachable("unknown AST node kind");
+    }
+
+    RetTy visitNode(ASTNode *N) {
+        forEachChild(N, [this](ASTNode *&Child) { self().visit(Child); });
+        return RetTy();
+    }
+
+#define QUANTA_VISIT_DEFAULT(Kind, Class) \
+    RetTy visit##Kind(Class *N) { return self().visitNode(N); }
+    QUANTA_AST_NODES(QUANTA_VISIT_DEFAULT)
+#undef QUANTA_VISIT_DEFAULT
+};
+
+// --- TYPE ANNOTATION ---
+// Sets Ty on every node of F's body (sema.cpp). Codegen runs it first thing
+// for each function, so IR is emitted from known types rather than from
+// whatever a child's IR happened to be. Outer gives the variables already
+// in scope (the REPL's session variables).
+void annotateTypes(FunctionAST *F, llvm::ArrayRef<std::pair<SymbolID, QType>> Outer = {});
+
+// What the spellings in a signature or declaration store as
+QType variableType(const std::string &Type, int Bytes); // int32 x = ...
+QType parameterType(const std::string &Type);
+QType returnType(const std::string &Type);
+QType elementType(const std::string &Type);             // int[4] a, int[] l
+// Both operands of arithmetic or a comparison are converted to this
+QType arithmeticType(QType L, QType R);
+
+// --- CONSTANT FOLDING ---
+// Rewrites F's body in place (fold.cpp): arithmetic, comparisons, string
+// methods and slices on literals become literals, as do reads of variables
+// that are declared once with a constant and never written, and calls to
+// 'const' functions with literal arguments (evaluateConstCall()).
+// Branches on a constant condition lose their dead arm, loops that never run
+// disappear, and so do statements after a return. New nodes come from Arena,
+// which must outlive F.
+void foldConstants(FunctionAST *F, ASTArena &Arena);
+
 // --- 3. PARSER ---
 // [IMPORTANT] Returns ProgramAST (List of Functions), not a single function pointer.
-ProgramAST parse(const std::vector<Token>& tokens);
+ProgramAST parse(Lexer &lexer);
+// Fills BinopPrecedence; needed once before the first parse
+void initializeOperators();
+
+// --stream: beginStream() does all of parse() except function bodies, so the
+// program it returns holds every signature of this file with an empty body.
+// nextStreamedFunction() then parses one body at a time into Arena and
+// returns its function, null when there are none left: this file's functions
+// in order, the generated main, then the imported functions the program
+// reaches. The caller may free Arena once the function is generated.
+ProgramAST beginStream(Lexer &lexer);
+FunctionAST *nextStreamedFunction(ASTArena &Arena);
+void endStream(ProgramAST &program);
+
+// quanta repl: parses one input on top of the inputs before it, whose
+// functions and imports stay known (so their programs must stay alive). The
+// input's top-level statements become the void function Entry, last in the
+// returned program.
+ProgramAST parseReplInput(Lexer &lexer, SymbolID Entry);
+
+// quanta lsp: a file is kept as its top-level pieces, each lexed and parsed
+// on its own, so an edit only redoes the pieces it touches. A piece is one
+// function definition (from where isFunctionDefinition() matches through its
+// closing '}') or the script code between two of them. It starts just past
+// the previous piece's last token, so the pieces tile the file.
+struct TopLevelPiece {
+    size_t Begin;                      // Offset in the file
+    int Line;                          // Line at Begin
+    size_t Horizon = 0;                // Where the piece ends was decided on the
+                                       // text before this offset (lookahead)
+    bool IsFunction = false;
+    bool HasImport = false;
+    SymbolID Name = SYM_NONE;          // Functions: the name, and where it
+    size_t NameOffset = 0;             // is relative to Begin and Line
+    int NameLine = 0;
+    std::vector<SymbolID> Identifiers; // Every identifier it uses, sorted
+};
+// Splits Source from Begin (on line Line, between two top-level tokens) to
+// its end, but stops before a piece that would start at an offset Resume
+// accepts: the caller's old pieces line up again from there. After an edit,
+// the pieces whose Horizon lies before it are still valid.
+std::vector<TopLevelPiece> splitTopLevel(std::string_view Source, size_t Begin, int Line,
+                                         llvm::function_ref<bool(size_t)> Resume);
+// Parses the text of one piece (starting on line Line) into Arena. Returns
+// its function, registered in FunctionRegistry, or null for script code,
+// whose statements go to Statements. Diagnostics go to Diag.
+FunctionAST *parsePiece(std::string_view Text, int Line, bool IsFunction, ASTArena &Arena,
+                        std::vector<ASTNode*> &Statements, std::ostream &Diag);
+// Loads every module Source imports, as parse() would: afterwards
+// FunctionRegistry and LoadedModules hold just what they provide. The
+// modules' arenas are appended to Arenas.
+void loadImports(std::string_view Source, std::vector<std::unique_ptr<ASTArena>> &Arenas);
+// Whether any of these modules (as in LoadedModules, found from RootDir)
+// changed on disk since it was read, so what it provides is out of date.
+bool modulesOutdated(const std::unordered_set<SymbolID> &Modules);
 
 // --- 4. UTILS ---
 void initializeModule();
-void generateObjectCode();
+// Host backend only, and one TargetMachine kept for every object emitted
+bool initializeBackend();
+bool generateObjectCode(const std::string &Filename);
+bool emitObjectFile(const std::string &Filename);
+bool emitObject(llvm::raw_pwrite_stream &Out);
+// --split: swap in a fresh module in the same context. Functions emitted into
+// earlier modules are declared again on first call.
+void startNewModule(const std::string &Name);
+// -O: mem2reg, instcombine, reassociate, GVN and CFG simplification, run on
+// each function as soon as it is generated.
+void optimizeFunction(llvm::Function &F);
+// quanta repl: beginReplInput() starts the module for one input and
+// codegenReplEntry() generates its top-level statements. Variables they
+// create are globals; commitReplInput() makes them visible to later inputs
+// once the input has been compiled and linked.
+void beginReplInput(const std::string &Name);
+llvm::Function *codegenReplEntry(FunctionAST *Entry);
+void commitReplInput();
+
+// --- 5. REPORTS ---
+// --stack-report: the backend writes per-function frame sizes to this file,
+// a temporary next to the object that printStackReport() removes, and
+// CallAST::codegen() records every call edge it emits.
+extern bool StackReport;
+extern std::string StackUsageFile;
+void recordCallEdge(const std::string &Caller, const std::string &Callee);
+void printStackReport();
+
+// --size-report: attribute the linked image to Quanta code, quanta_* runtime
+// helpers, pooled string literals and libc, per section.
+extern bool SizeReport;
+void printSizeReport(const std::string &ImagePath);
+
+// --- 6. DRIVER ---
+// Everything 'quanta <Args>' does: compile, link and run one program.
+int runQuanta(const std::vector<std::string> &Args);
+
+struct CompileOptions {
+    std::string Source;
+    std::string Object = "output.o";         // --split: output.1.o, output.2.o, ...
+    std::string Executable = "my_quanta_app";
+    bool KeepObjects = true;                 // Otherwise removed once linked
+    bool Run = true;                         // Run the program once it is linked
+    bool Stream = false;                     // --stream
+    bool Optimize = false;                   // -O
+    unsigned SplitEvery = 0;                 // --split N
+    bool Tiered = false;                     // --tiered: run in this process, no object or link
+    unsigned TierUpAt = 1000;                // --tier-up N
+};
+int compileProgram(const CompileOptions &Opts);
+// --tiered: runs a program whose IR is already in TheModule. Tier 0
+// interprets the AST; a function that has been called or looped TierUpAt
+// times is compiled from that IR and runs natively from its next call on.
+// Returns main's exit code, or -1 if the program could not be run.
+int runTiered(const ProgramAST &Program, unsigned TierUpAt);
+// Runs a call whose arguments are all literals in tier 0, at compile time,
+// and returns the literal it comes to (made in Arena). Null when it cannot
+// be done here: the call prints, uses containers, traps, reads a variable
+// of the caller, reaches a body that is not parsed (--stream) or runs too
+// long; the call is then generated as usual.
+ASTNode *evaluateConstCall(CallAST *Call, ASTArena &Arena);
+// Handles Args[I] if it is a code generation flag (-O, --stream, --split N),
+// moving I past its value: 1 if handled, 0 if not one, -1 on a bad value.
+int parseCodegenFlag(const std::vector<std::string> &Args, size_t &I, CompileOptions &Opts);
+
+// quanta build [-j N] [-o outdir] <files or dirs>: compile many programs at
+// once, each into outdir/<name>, without running them.
+int runBuild(const std::vector<std::string> &Args);
+// Compiles quanta_lib.c into Object and links against that from then on
+bool prebuildRuntime(const std::string &Object);
+// Reads and scans every module SourcePath imports, directly or not, into the
+// parser's module cache.
+void preloadImports(const std::string &SourcePath);
+// --server: keep the backend and the runtime warm and run requests from
+// quanta-client (see quanta_server.h), each in a fork of the warm process.
+// An empty SocketPath means defaultServerSocket().
+int runServer(const std::string &SocketPath);
+// quanta repl [-O]: read, compile and run statements and functions one input
+// at a time in a persistent JIT session.
+int runRepl(const std::vector<std::string> &Args);
+// quanta lsp: a language server on stdin/stdout (diagnostics, go to
+// definition, signature help).
+int runLsp(const std::vector<std::string> &Args);
 
 #endif
\ No newline at end of file
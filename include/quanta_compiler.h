@@ -0,0 +1,63 @@
+#ifndef QUANTA_COMPILER_H
+#define QUANTA_COMPILER_H
+
+// --- EMBEDDING API (quanta_compiler library) ---
+// Compiles Quanta source inside another program. Nothing is printed and
+// nothing exits: what the command line would report comes back in
+// Diagnostics. The compiler keeps global state, so compiles in one process
+// take turns (calls from several threads are serialized).
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace quanta {
+
+struct Options {
+    std::string ImportDir = "./"; // Where 'import mod' looks for mod.qnt
+    bool Optimize = false;        // Same as -O
+};
+
+struct ObjectResult {
+    std::unique_ptr<llvm::MemoryBuffer> Object; // Native object file; null on failure
+    std::string Diagnostics;
+};
+
+// The object still has to be linked with the runtime (quanta_lib.c, which
+// this library also contains) and libc.
+ObjectResult compileToObject(std::string_view Source, const Options &Opts = Options());
+
+// A program compiled into this process. Its code lives as long as this object.
+class JITProgram {
+public:
+    explicit JITProgram(std::unique_ptr<llvm::orc::LLJIT> JIT) : JIT(std::move(JIT)) {}
+
+    // Address of a Quanta function (or of 'main'); null if there is none.
+    // Quanta 'int' is int32_t, 'float' is float and 'string' is char*,
+    // e.g. getFunction<int(int, int)>("add").
+    template <typename Fn>
+    Fn *getFunction(const std::string &Name) const {
+        return reinterpret_cast<Fn*>(lookup(Name));
+    }
+    void *lookup(const std::string &Name) const;
+
+private:
+    std::unique_ptr<llvm::orc::LLJIT> JIT;
+};
+
+struct JITResult {
+    std::unique_ptr<JITProgram> Program; // Null on failure
+    std::string Diagnostics;
+};
+
+JITResult compileToJIT(std::string_view Source, const Options &Opts = Options());
+
+// An empty LLJIT that Quanta modules can be added to: libc comes from this
+// process and the runtime from this library.
+llvm::Expected<std::unique_ptr<llvm::orc::LLJIT>> createJIT();
+
+} // namespace quanta
+
+#endif
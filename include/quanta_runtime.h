@@ -0,0 +1,37 @@
+#ifndef QUANTA_RUNTIME_H
+#define QUANTA_RUNTIME_H
+
+// The string runtime (quanta_lib.c), for code that runs Quanta in this
+// process instead of linking a program against it.
+
+extern "C" {
+char *quanta_upper(const char *str);
+char *quanta_lower(const char *str);
+char *quanta_reverse(const char *str);
+int quanta_isupper(const char *str);
+int quanta_islower(const char *str);
+char *quanta_strip(const char *str);
+char *quanta_lstrip(const char *str);
+char *quanta_rstrip(const char *str);
+char *quanta_capitalize(const char *str);
+char *quanta_title(const char *str);
+int quanta_isalpha(const char *str);
+int quanta_isdigit(const char *str);
+int quanta_isspace(const char *str);
+int quanta_isalnum(const char *str);
+int quanta_find(const char *str, const char *sub);
+int quanta_count(const char *str, const char *sub);
+int quanta_startswith(const char *str, const char *prefix);
+int quanta_endswith(const char *str, const char *suffix);
+char *quanta_replace(const char *str, const char *old, const char *newstr);
+char *quanta_slice(const char *s, int start, int end, int step);
+}
+
+#define QUANTA_RUNTIME(X) \
+    X(quanta_upper) X(quanta_lower) X(quanta_reverse) X(quanta_isupper) \
+    X(quanta_islower) X(quanta_strip) X(quanta_lstrip) X(quanta_rstrip) \
+    X(quanta_capitalize) X(quanta_title) X(quanta_isalpha) X(quanta_isdigit) \
+    X(quanta_isspace) X(quanta_isalnum) X(quanta_find) X(quanta_count) \
+    X(quanta_startswith) X(quanta_endswith) X(quanta_replace) X(quanta_slice)
+
+#endif
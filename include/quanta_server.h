@@ -0,0 +1,30 @@
+#ifndef QUANTA_SERVER_H
+#define QUANTA_SERVER_H
+
+// --- COMPILE SERVER PROTOCOL ---
+// 'quanta --server' listens on a Unix socket and quanta-client makes one
+// request per connection:
+//   1. a RequestHeader, with the client's stdin, stdout and stderr attached
+//      (SCM_RIGHTS), so the compiler and the program talk to its terminal;
+//   2. Length bytes: the working directory, then each argument of the
+//      'quanta' command line, every one NUL-terminated.
+// The server answers with the exit status (int32_t) when the request is
+// done. A connection closed without an answer counts as exit status 1.
+// Kept free of LLVM so the client stays a small program.
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+
+struct RequestHeader {
+    uint32_t Length;
+};
+
+// $XDG_RUNTIME_DIR/quanta-<uid>.sock, or under /tmp
+inline std::string defaultServerSocket() {
+    const char *Dir = std::getenv("XDG_RUNTIME_DIR");
+    return std::string(Dir && *Dir ? Dir : "/tmp") + "/quanta-" + std::to_string(getuid()) + ".sock";
+}
+
+#endif
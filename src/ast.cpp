@@ -0,0 +1,101 @@
+#include "../include/quanta.h"
+
+// --- AST WALKING ---
+// The one place that knows where each node keeps its children. Passes built
+// on ASTVisitor get their traversal from here.
+
+static void each(std::vector<ASTNode*> &List, llvm::function_ref<void(ASTNode *&)> Fn) {
+    for (ASTNode *&Child : List)
+        if (Child) Fn(Child);
+}
+
+static void one(ASTNode *&Child, llvm::function_ref<void(ASTNode *&)> Fn) {
+    if (Child) Fn(Child);
+}
+
+void forEachChild(ASTNode *N, llvm::function_ref<void(ASTNode *&)> Fn) {
+    using llvm::cast;
+
+    switch (N->getKind()) {
+    // Leaves
+    case NK_Number:
+    case NK_Float:
+    case NK_Bool:
+    case NK_Char:
+    case NK_String:
+    case NK_Variable:
+    case NK_ByteSize:
+    case NK_UpdateExpr:
+    case NK_Typeof:
+        return;
+
+    case NK_Assignment:      one(cast<AssignmentAST>(N)->RHS, Fn); return;
+    case NK_VarDecl:         one(cast<VarDeclAST>(N)->InitVal, Fn); return;
+    case NK_FixedStringDecl: one(cast<FixedStringDeclAST>(N)->InitValue, Fn); return;
+    case NK_FixedArrayDecl:  one(cast<FixedArrayDeclAST>(N)->InitValue, Fn); return;
+    case NK_DynamicListDecl: one(cast<DynamicListDeclAST>(N)->InitValue, Fn); return;
+    case NK_Return:          one(cast<ReturnAST>(N)->Expr, Fn); return;
+
+    case NK_Print:     each(cast<PrintAST>(N)->Args, Fn); return;
+    case NK_Block:     each(cast<BlockAST>(N)->Statements, Fn); return;
+    case NK_ArrayExpr: each(cast<ArrayExprAST>(N)->Elements, Fn); return;
+    case NK_Function:  each(cast<FunctionAST>(N)->Body, Fn); return;
+
+    case NK_BinaryExpr: {
+        auto *B = cast<BinaryExprAST>(N);
+        one(B->LHS, Fn);
+        one(B->RHS, Fn);
+        return;
+    }
+    case NK_Call:
+        for (CallArg &Arg : cast<CallAST>(N)->Args) one(Arg.Val, Fn);
+        return;
+    case NK_Loop: {
+        auto *L = cast<LoopAST>(N);
+        one(L->Cond, Fn);
+        one(L->Body, Fn);
+        return;
+    }
+    case NK_LoopOverString: {
+        auto *L = cast<LoopOverStringAST>(N);
+        one(L->StringExpr, Fn);
+        one(L->Body, Fn);
+        return;
+    }
+    case NK_StringIndex: {
+        auto *I = cast<StringIndexAST>(N);
+        one(I->BaseExpr, Fn);
+        one(I->IndexExpr, Fn);
+        return;
+    }
+    case NK_StringSlice: {
+        auto *S = cast<StringSliceAST>(N);
+        one(S->BaseExpr, Fn);
+        one(S->StartExpr, Fn);
+        one(S->EndExpr, Fn);
+        one(S->StepExpr, Fn);
+        return;
+    }
+    case NK_IfExpr: {
+        auto *I = cast<IfExprAST>(N);
+        one(I->Cond, Fn);
+        one(I->Then, Fn);
+        one(I->Else, Fn);
+        return;
+    }
+    case NK_IndexAssign: {
+        auto *A = cast<IndexAssignAST>(N);
+        one(A->Obj, Fn);
+        one(A->Index, Fn);
+        one(A->Value, Fn);
+        return;
+    }
+    case NK_MethodCall: {
+        auto *M = cast<MethodCallAST>(N);
+        one(M->Obj, Fn);
+        each(M->Args, Fn);
+        return;
+    }
+    }
+    llvm_unreachable("unknown AST node kind");
+}
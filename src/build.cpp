@@ -0,0 +1,207 @@
+#include "../include/quanta.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <thread>
+
+#ifndef _WIN32
+#include <cstring>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// --- QUANTA BUILD ---
+// Every program gets its own executable (outdir/<name>) and a unique
+// temporary object, so builds in one directory never meet on output.o or
+// my_quanta_app. The work programs share is done once, up front: the
+// backend, the runtime object and every imported module (preloadImports()).
+// Each program is then compiled in a fork of this process, up to -j at a
+// time, with its output captured and printed in one piece. Windows has no
+// fork, so there the programs are compiled one after the other.
+
+struct BuildJob {
+    CompileOptions Opts;
+    std::string LogFile; // Captured stdout and stderr of the compile
+    int Status = 1;
+};
+
+// A file as is; a directory: every .qnt file under it, in name order
+static void collectSources(const std::string &Path, std::vector<std::string> &Sources) {
+    if (!llvm::sys::fs::is_directory(Path)) {
+        Sources.push_back(Path);
+        return;
+    }
+    std::vector<std::string> Found;
+    std::error_code EC;
+    for (llvm::sys::fs::recursive_directory_iterator It(Path, EC), End; It != End && !EC; It.increment(EC)) {
+        if (llvm::sys::path::extension(It->path()) == ".qnt" && llvm::sys::fs::is_regular_file(It->path()))
+            Found.push_back(It->path());
+    }
+    std::sort(Found.begin(), Found.end());
+    Sources.insert(Sources.end(), Found.begin(), Found.end());
+}
+
+static void reportJob(const BuildJob &J) {
+    if (J.Status == 0) {
+        std::cout << "[Build] " << J.Opts.Source << " -> " << J.Opts.Executable << std::endl;
+    } else {
+        if (auto Log = llvm::MemoryBuffer::getFile(J.LogFile)) std::cerr << (*Log)->getBuffer().str();
+        std::cerr << "[Build] FAILED: " << J.Opts.Source << std::endl;
+    }
+    llvm::sys::fs::remove(J.LogFile);
+    llvm::sys::fs::remove(J.Opts.Object); // Only still there if the compile failed early
+}
+
+// The whole of Text must be the number: "-3" and "4x" are mistakes, not 0 and 4
+static bool parseJobCount(const std::string &Text, unsigned &Jobs) {
+    errno = 0;
+    char *End = nullptr;
+    long Value = std::strtol(Text.c_str(), &End, 10);
+    if (End == Text.c_str() || *End || errno == ERANGE || Value <= 0 || Value > UINT_MAX) return false;
+    Jobs = (unsigned)Value;
+    return true;
+}
+
+int runBuild(const std::vector<std::string> &Args) {
+    CompileOptions base;
+    base.Run = false;
+    base.KeepObjects = false;
+    unsigned maxJobs = std::max(1u, std::thread::hardware_concurrency());
+    std::string outDir = ".";
+    std::vector<std::string> sources;
+
+    for (size_t i = 0; i < Args.size(); i++) {
+        const std::string &arg = Args[i];
+        int handled = parseCodegenFlag(Args, i, base);
+        if (handled < 0) return 1;
+        if (handled) continue;
+
+        if (arg == "-j" || arg == "-o") {
+            if (i + 1 >= Args.size()) {
+                std::cerr << "Error: " << arg << " expects a value" << std::endl;
+                return 1;
+            }
+            if (arg == "-o") {
+                outDir = Args[++i];
+            } else if (!parseJobCount(Args[++i], maxJobs)) {
+                std::cerr << "Error: -j expects a positive job count" << std::endl;
+                return 1;
+            }
+        } else if (arg.rfind("-", 0) == 0) {
+            std::cerr << "Error: Unknown build option " << arg << std::endl;
+            return 1;
+        } else {
+            collectSources(arg, sources);
+        }
+    }
+    if (sources.empty()) {
+        std::cerr << "Usage: quanta build [--stream] [--split N] [-O] [-j N] [-o outdir] <files or dirs>" << std::endl;
+        return 1;
+    }
+    if (std::error_code EC = llvm::sys::fs::create_directories(outDir)) {
+        std::cerr << "Error: Could not create " << outDir << ": " << EC.message() << std::endl;
+        return 1;
+    }
+
+    // 1. One job per program, with its own output paths
+    std::vector<BuildJob> jobs;
+    std::map<std::string, std::string> builtBy; // Executable -> source
+    for (const std::string &source : sources) {
+        BuildJob J;
+        J.Opts = base;
+        J.Opts.Source = source;
+        llvm::SmallString<128> exe(outDir);
+        llvm::sys::path::append(exe, llvm::sys::path::stem(source));
+        J.Opts.Executable = std::string(exe);
+
+        auto [It, Fresh] = builtBy.emplace(J.Opts.Executable, source);
+        if (!Fresh) {
+            std::cerr << "Error: " << It->second << " and " << source << " would both build " << It->first << std::endl;
+            return 1;
+        }
+
+        llvm::SmallString<128> object, log;
+        std::string prefix = "quanta-" + llvm::sys::path::stem(source).str();
+        if (llvm::sys::fs::createTemporaryFile(prefix, "o", object) ||
+            llvm::sys::fs::createTemporaryFile(prefix, "log", log)) {
+            std::cerr << "Error: Could not create temporary files for " << source << std::endl;
+            return 1;
+        }
+        J.Opts.Object = std::string(object);
+        J.LogFile = std::string(log);
+        jobs.push_back(std::move(J));
+    }
+
+    // 2. Shared work, done once
+    if (!initializeBackend()) return 1;
+    llvm::SmallString<128> runtime;
+    if (!llvm::sys::fs::createTemporaryFile("quanta_lib", "o", runtime)) prebuildRuntime(std::string(runtime));
+    for (const BuildJob &J : jobs) preloadImports(J.Opts.Source);
+
+    // 3. Compile
+    size_t failed = 0;
+#ifdef _WIN32
+    for (BuildJob &J : jobs) {
+        J.Status = compileProgram(J.Opts);
+        if (J.Status) failed++;
+        reportJob(J);
+    }
+#else
+    std::map<pid_t, BuildJob*> running;
+    size_t next = 0;
+    while (next < jobs.size() || !running.empty()) {
+        if (next < jobs.size() && running.size() < maxJobs) {
+            BuildJob &J = jobs[next++];
+            std::cout.flush();
+            std::cerr.flush();
+            pid_t pid = fork();
+            if (pid == 0) {
+                int log = open(J.LogFile.c_str(), O_WRONLY | O_TRUNC);
+                if (log >= 0) {
+                    dup2(log, 1);
+                    dup2(log, 2);
+                    close(log);
+                }
+                int status = compileProgram(J.Opts);
+                std::cout.flush();
+                std::cerr.flush();
+                fflush(nullptr);
+                _exit(status);
+            }
+            if (pid < 0) {
+                std::cerr << "Error: fork failed: " << std::strerror(errno) << std::endl;
+                failed++;
+                reportJob(J);
+                continue;
+            }
+            running[pid] = &J;
+            continue;
+        }
+
+        int wstatus;
+        pid_t pid = waitpid(-1, &wstatus, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        auto It = running.find(pid);
+        if (It == running.end()) continue;
+        BuildJob &J = *It->second;
+        running.erase(It);
+        J.Status = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 1;
+        if (J.Status) failed++;
+        reportJob(J);
+    }
+#endif
+
+    if (!runtime.empty()) llvm::sys::fs::remove(runtime);
+    std::cout << "[Build] " << jobs.size() - failed << " of " << jobs.size() << " programs built" << std::endl;
+    return failed ? 1 : 0;
+}
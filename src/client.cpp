@@ -0,0 +1,75 @@
+// quanta-client: runs 'quanta <args>' on a running 'quanta --server'.
+// It links nothing but libc, so a request costs one connect instead of a
+// compiler startup.
+//
+//   quanta-client [--socket PATH] [quanta flags] file.qnt
+
+#include "../include/quanta_server.h"
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+int main(int argc, char *argv[]) {
+    std::string SocketPath = defaultServerSocket();
+    int First = 1;
+    if (argc > 2 && std::strcmp(argv[1], "--socket") == 0) {
+        SocketPath = argv[2];
+        First = 3;
+    }
+
+    // 1. Working directory and arguments, NUL-terminated
+    char Cwd[PATH_MAX];
+    if (!getcwd(Cwd, sizeof(Cwd))) {
+        std::cerr << "Error: Could not get the working directory" << std::endl;
+        return 1;
+    }
+    std::string Payload(Cwd);
+    Payload.push_back('\0');
+    for (int I = First; I < argc; I++) {
+        Payload += argv[I];
+        Payload.push_back('\0');
+    }
+
+    // 2. Connect
+    sockaddr_un Addr{};
+    Addr.sun_family = AF_UNIX;
+    if (SocketPath.size() >= sizeof(Addr.sun_path)) {
+        std::cerr << "Error: Socket path too long: " << SocketPath << std::endl;
+        return 1;
+    }
+    std::strcpy(Addr.sun_path, SocketPath.c_str());
+    int Conn = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (Conn < 0 || connect(Conn, (sockaddr*)&Addr, sizeof(Addr)) != 0) {
+        std::cerr << "Error: No Quanta server at " << SocketPath << " (start one with 'quanta --server')" << std::endl;
+        return 1;
+    }
+
+    // 3. Header with our stdin/stdout/stderr attached, then the payload
+    RequestHeader Header{(uint32_t)Payload.size()};
+    int Fds[3] = {0, 1, 2};
+    char Control[CMSG_SPACE(sizeof(Fds))] = {};
+    iovec IOV{&Header, sizeof(Header)};
+    msghdr Msg{};
+    Msg.msg_iov = &IOV;
+    Msg.msg_iovlen = 1;
+    Msg.msg_control = Control;
+    Msg.msg_controllen = sizeof(Control);
+    cmsghdr *C = CMSG_FIRSTHDR(&Msg);
+    C->cmsg_level = SOL_SOCKET;
+    C->cmsg_type = SCM_RIGHTS;
+    C->cmsg_len = CMSG_LEN(sizeof(Fds));
+    std::memcpy(CMSG_DATA(C), Fds, sizeof(Fds));
+
+    if (sendmsg(Conn, &Msg, 0) != (ssize_t)sizeof(Header) ||
+        write(Conn, Payload.data(), Payload.size()) != (ssize_t)Payload.size()) {
+        std::cerr << "Error: Could not send the request to " << SocketPath << std::endl;
+        return 1;
+    }
+
+    // 4. Exit status, once the server is done with our terminal
+    int32_t Status;
+    if (recv(Conn, &Status, sizeof(Status), MSG_WAITALL) != (ssize_t)sizeof(Status)) return 1;
+    return Status;
+}
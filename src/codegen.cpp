@@ -11,6 +11,12 @@
 #include "llvm/TargetParser/Host.h"
 #include "llvm/TargetParser/Triple.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Transforms/InstCombine/InstCombine.h"
+#include "llvm/Transforms/Scalar/GVN.h"
+#include "llvm/Transforms/Scalar/Reassociate.h"
+#include "llvm/Transforms/Scalar/SimplifyCFG.h"
+#include "llvm/Transforms/Utils/Mem2Reg.h"
 #include <map>
 #include <iostream>
 #include <vector>
@@ -18,31 +24,104 @@
 
 
 llvm::Value *LogErrorV(const char *Str) {
-    std::cerr << "[Codegen Error] " << Str << std::endl;
+    diag() << "[Codegen Error] " << Str << std::endl;
     return nullptr;
 }
 
 // --- GLOBALS ---
-extern std::unique_ptr<llvm::LLVMContext> TheContext;
-extern std::unique_ptr<llvm::Module> TheModule;
-extern std::unique_ptr<llvm::IRBuilder<>> Builder;
+std::unique_ptr<llvm::LLVMContext> TheContext;
+std::unique_ptr<llvm::Module> TheModule;
+std::unique_ptr<llvm::IRBuilder<>> Builder;
 
 // --- KEEP THIS ONCE ---
 struct VarInfo {
-    llvm::AllocaInst *Alloca;
+    llvm::Value *Alloca; // Stack slot, or a global for REPL variables
     llvm::Type *Type;
     std::string TypeName;
     llvm::Type *ElementType; // For Arrays and Lists
 };
 
-// Global Variable Registry
-static std::map<std::string, VarInfo> NamedValues;
+// Local variables of the function being generated
+static ScopedSymbolTable<VarInfo> NamedValues;
 static std::map<std::string, llvm::Value*> StringPool;
+static std::unordered_set<SymbolID> DefinedFunctions; // Across --split modules
+// Literals made by foldConstants(); they outlive the parse (--stream frees a
+// body's arena after codegen, while --tiered interprets bodies afterwards)
+static std::unique_ptr<ASTArena> FoldedNodes = std::make_unique<ASTArena>();
+
+// --- REPL VARIABLES ---
+// Variables made at the top level of a 'quanta repl' input are globals, so
+// that later inputs, each compiled into a module of its own, link to them.
+// ReplVariables remembers them (global name and type) between inputs.
+struct ReplVariable {
+    std::string Global;
+    llvm::Type *GlobalType;
+    VarInfo Info; // Alloca is only valid in the module that made it
+};
+static std::unordered_map<SymbolID, ReplVariable> ReplVariables, PendingReplVariables;
+static bool ReplEntry = false; // Generating an input's top-level statements
+static unsigned ReplGlobalCount = 0;
+
+static llvm::Value *createReplGlobal(llvm::Type *Ty, const std::string &Name) {
+    return new llvm::GlobalVariable(*TheModule, Ty, false, llvm::GlobalValue::ExternalLinkage,
+                                    llvm::Constant::getNullValue(Ty),
+                                    "repl." + Name + "." + std::to_string(++ReplGlobalCount));
+}
+
+static llvm::Type *slotType(llvm::Value *Slot) {
+    if (auto *A = llvm::dyn_cast<llvm::AllocaInst>(Slot)) return A->getAllocatedType();
+    return llvm::cast<llvm::GlobalVariable>(Slot)->getValueType();
+}
+
+// --- TYPES ---
+// Scalar types only: arrays and lists are built by their declarations
+static llvm::Type *llvmType(QType T) {
+    switch (T.Kind) {
+        case QType::Int:    return llvm::IntegerType::get(*TheContext, T.Bits);
+        case QType::Float:  return T.Bits == 32 ? Builder->getFloatTy() : Builder->getDoubleTy();
+        case QType::String: return Builder->getPtrTy();
+        case QType::Void:   return Builder->getVoidTy();
+        default:            return nullptr;
+    }
+}
+
+static QType irType(llvm::Type *T) {
+    if (T->isIntegerTy()) return QType::integer(T->getIntegerBitWidth());
+    if (T->isFloatTy()) return QType::floating(32);
+    if (T->isDoubleTy()) return QType::floating(64);
+    if (T->isPointerTy()) return QType::string();
+    return {};
+}
+
+static QType variableType(const VarInfo &Info) {
+    if (Info.Type->isArrayTy()) return QType::container(QType::Array, irType(Info.ElementType));
+    if (Info.Type->isStructTy()) return QType::container(QType::List, irType(Info.ElementType));
+    return irType(Info.Type);
+}
+
+// What annotateTypes() worked out for a generated child. The only values it
+// cannot type are calls outside the registry (e.g. a runtime helper the
+// module already declares); for those the IR is all there is.
+static QType typeOf(ASTNode *N, llvm::Value *V) {
+    return N->Ty.Kind != QType::Unknown ? N->Ty : irType(V->getType());
+}
+
+// Numeric conversion; integers are sign-extended (a bool true becomes -1)
+static llvm::Value *convertNumber(llvm::Value *V, QType From, QType To) {
+    llvm::Type *T = llvmType(To);
+    if (From == To || V->getType() == T) return V;
+    if (From.Kind == QType::Int)
+        return To.Kind == QType::Int ? Builder->CreateIntCast(V, T, true, "grow")
+                                     : Builder->CreateSIToFP(V, T, "cast_int_to_float");
+    return To.Kind == QType::Float ? Builder->CreateFPCast(V, T, "fp_resize")
+                                   : Builder->CreateFPToSI(V, T, "cast_float_to_int");
+}
 // static std::vector<llvm::Value*> AutoFreeList;
 
 // --- AUTO-FREE MEMORY TRACKER ---
 static std::map<llvm::Function*, std::vector<llvm::AllocaInst*>> AutoFreeMap;
 void trackForAutoFree(llvm::Value *HeapPtr) {
+    if (ReplEntry) return; // Lives as long as the session's variables
     // 1. Go to the very top of the function (Entry Block)
     llvm::Function *TheFunction = Builder->GetInsertBlock()->getParent();
     llvm::IRBuilder<> TmpB(&TheFunction->getEntryBlock(), TheFunction->getEntryBlock().begin());
@@ -62,7 +141,7 @@ void trackForAutoFree(llvm::Value *HeapPtr) {
 
 // Global Function Registry
 // std::map<std::string, FunctionInfo> FunctionRegistry;
-extern std::map<std::string, FunctionInfo> FunctionRegistry;
+extern std::unordered_map<SymbolID, FunctionInfo> FunctionRegistry;
 // ----------------------
 llvm::Value* getPooledString(const std::string& str, const std::string& label = "str_pool") {
     if (StringPool.find(str) == StringPool.end()) {
@@ -236,11 +315,16 @@ llvm::Function* getStrcmpFunc() {
 
 // --- 1. SETUP ---
 void initializeModule() {
+    // A previous compile's module and builder must go before their context
+    Builder.reset();
+    TheModule.reset();
     TheContext = std::make_unique<llvm::LLVMContext>();
     TheModule = std::make_unique<llvm::Module>("QuantaModule", *TheContext);
     Builder = std::make_unique<llvm::IRBuilder<>>(*TheContext);
     NamedValues.clear(); 
     StringPool.clear(); 
+    DefinedFunctions.clear();
+    FoldedNodes = std::make_unique<ASTArena>();
 }
 
 
@@ -248,7 +332,7 @@ void initializeModule() {
 // --- 2. PRIMITIVE VALUES ---
 llvm::Value *NumberAST::codegen() {
    
-    return llvm::ConstantInt::get(*TheContext, llvm::APInt(64, Val, true));
+    return llvm::ConstantInt::get(*TheContext, llvm::APInt(Bits, Val, true));
     
 }
 // llvm::Value *ReturnAST::codegen() {
@@ -270,72 +354,66 @@ llvm::Value *NumberAST::codegen() {
 //     }
 // }
 
-llvm::Function *FunctionAST::codegen() {
+llvm::Function *FunctionAST::codegenPrototype() {
     // 1. Prepare Argument Types for LLVM
     std::vector<llvm::Type*> ArgsTypes;
-    
-    for (const auto &Arg : Args) {
-        if (Arg.Type == "float") {
-            ArgsTypes.push_back(Builder->getFloatTy());
-        } else if (Arg.Type == "double") {
-            ArgsTypes.push_back(Builder->getDoubleTy());
-        } else if (Arg.Type == "string") {
-            ArgsTypes.push_back(Builder->getPtrTy());
-        } else if (Arg.Type == "int8") {
-            ArgsTypes.push_back(Builder->getInt8Ty());
-        } else {
-            // Default to 32-bit int for "int" or unknown types
-            ArgsTypes.push_back(Builder->getInt32Ty());
-        }
-    }
+    for (const auto &Arg : Args) ArgsTypes.push_back(llvmType(parameterType(Arg.Type)));
 
-    // 2. Define the Return Type
-    llvm::Type* RetTy;
-    if (ReturnType == "string") {
-        RetTy = Builder->getPtrTy();
-    } else if (ReturnType == "void") {
-        RetTy = Builder->getVoidTy();
-    } else if (ReturnType == "float") {
-        RetTy = Builder->getFloatTy();
-    } else if (ReturnType == "double") {
-        RetTy = Builder->getDoubleTy();
-    } else if (ReturnType.find("int") == 0) {
-        int bits = 32;
-        if (ReturnType.size() > 3) {
-            // FIX: Removed '* 8' so int8 is 8 bits, not 64 bits
-            bits = std::atoi(ReturnType.substr(3).c_str()); 
-        }
-        RetTy = llvm::IntegerType::get(*TheContext, bits);
-    } else {
-        RetTy = llvm::Type::getInt32Ty(*TheContext);
-    }
+    // 2. Define the Return Type ("int" or unknown types are 32-bit ints)
+    llvm::Type* RetTy = llvmType(returnType(ReturnType));
 
     // 3. Create the Function Type (Now includes ArgsTypes!)
     llvm::FunctionType *FT = llvm::FunctionType::get(RetTy, ArgsTypes, false);
     
-    // 4. Create the Function
-    llvm::Function *F = llvm::Function::Create(FT, llvm::Function::ExternalLinkage, Name, TheModule.get());
+    // 4. Reuse a declaration made for an earlier call (streaming, split
+    // modules); anything else with this name keeps the old renaming behaviour
+    const std::string &FnName = symbolName(Name);
+    if (llvm::Function *Existing = TheModule->getFunction(FnName))
+        if (Existing->empty() && Existing->getFunctionType() == FT) return Existing;
+    return llvm::Function::Create(FT, llvm::Function::ExternalLinkage, FnName, TheModule.get());
+}
+
+llvm::Function *FunctionAST::codegen() {
+    // 0. Fold constants, then type the whole body; REPL statements also see
+    // the session's variables
+    foldConstants(this, *FoldedNodes);
+    std::vector<std::pair<SymbolID, QType>> Outer;
+    if (ReplEntry)
+        NamedValues.forEachOutermost([&](SymbolID Name, const VarInfo &Info) { Outer.push_back({Name, variableType(Info)}); });
+    annotateTypes(this, Outer);
+
+    llvm::Function *F = codegenPrototype();
+    // A name defined twice: calls keep going to the first definition, later
+    // ones get a fresh local name (within one module LLVM renames them anyway,
+    // but the first may sit in an earlier --split module)
+    if (!DefinedFunctions.insert(Name).second) {
+        if (F->getName() == symbolName(Name))
+            F = llvm::Function::Create(F->getFunctionType(), llvm::Function::InternalLinkage, F->getName(), TheModule.get());
+        else
+            F->setLinkage(llvm::Function::InternalLinkage);
+    }
+    llvm::Type *RetTy = F->getReturnType();
     
     // 5. Create Entry Block
     llvm::BasicBlock *BB = llvm::BasicBlock::Create(*TheContext, "entry", F);
     Builder->SetInsertPoint(BB);
 
     // 6. --- PROCESS ARGUMENTS (NEW) ---
-    NamedValues.clear(); // Clear local variables from previous function
+    if (!ReplEntry) NamedValues.clear(); // Clear local variables from previous function
     unsigned Idx = 0;
     
    // Inside FunctionAST::codegen loop...
     for (auto &Arg : F->args()) {
-        std::string argName = Args[Idx].Name;
+        SymbolID argName = Args[Idx].Name;
         std::string argTypeStr = Args[Idx].Type; // "int", "float", etc.
-        Arg.setName(argName);
+        Arg.setName(symbolName(argName));
 
         // Create Stack Memory
-        llvm::AllocaInst *Alloca = Builder->CreateAlloca(Arg.getType(), nullptr, argName);
+        llvm::AllocaInst *Alloca = Builder->CreateAlloca(Arg.getType(), nullptr, symbolName(argName));
         Builder->CreateStore(&Arg, Alloca);
 
         // --- FIX: Store Alloca + LLVM Type + String Name ---
-        NamedValues[argName] = {Alloca, Arg.getType(), argTypeStr};
+        NamedValues.declare(argName, {Alloca, Arg.getType(), argTypeStr, nullptr});
 
         Idx++;
     }
@@ -413,16 +491,16 @@ llvm::Value *ReturnAST::codegen() {
     else {
         // --- ERROR HANDLING (Cannot Convert) ---
         std::string funcName = ParentFunc->getName().str();
-        std::cerr << "\n\033[1;31m[Quanta Error]\033[0m Type Mismatch in function '" 
+        diag() << "\n\033[1;31m[Quanta Error]\033[0m Type Mismatch in function '" 
                   << funcName << "' "
                   << "at line " << Line << "." << std::endl; 
 
         if (ActualTy->isPointerTy() && ExpectedTy->isIntegerTy()) {
-            std::cerr << "  Reason: Cannot implicitly convert a Pointer/String to an Integer." << std::endl;
+            diag() << "  Reason: Cannot implicitly convert a Pointer/String to an Integer." << std::endl;
         } else if (ActualTy->isIntegerTy() && ExpectedTy->isPointerTy()) {
-            std::cerr << "  Reason: Cannot implicitly convert an Integer to a Pointer." << std::endl;
+            diag() << "  Reason: Cannot implicitly convert an Integer to a Pointer." << std::endl;
         } else {
-            std::cerr << "  Reason: No valid casting rule found." << std::endl;
+            diag() << "  Reason: No valid casting rule found." << std::endl;
         }
 
         HasError = true; // Flag global error
@@ -476,31 +554,22 @@ llvm::Value *CharAST::codegen() {
 }
 
 llvm::Value *StringAST::codegen() {
-    // 1. Check if we have already generated this exact string
-    if (StringPool.find(val) != StringPool.end()) {
-        // We found it! Return the existing memory address
-        return StringPool[val];
-    }
-
-    // 2. If it's a new string, ask LLVM to create it in Global Memory
-    llvm::Value *newString = Builder->CreateGlobalString(val, "strtmp");
-    
-    // 3. Save it in our pool so we can reuse it next time!
-    StringPool[val] = newString;
-    
-    return newString;
+    // Written and folded literals alike: one global per distinct text
+    return getPooledString(val, "strtmp");
 }
 // --- 3. VARIABLES ---
 llvm::Value *VariableAST::codegen() {
-    if (NamedValues.find(Name) == NamedValues.end()) {
-        std::cerr << "[Quanta Error] Unknown variable: " << Name << std::endl;
-        exit(1);
+    VarInfo *Var = NamedValues.lookup(Name);
+    if (!Var) {
+        diag() << "[Quanta Error] Unknown variable: " << symbolName(Name) << std::endl;
+        HasError = true;
+        return nullptr;
     }
-    VarInfo& info = NamedValues[Name];
+    VarInfo& info = *Var;
     if (info.Type->isArrayTy() || info.Type->isStructTy()) {
         return info.Alloca; // Arrays and Lists shouldn't be loaded into registers by value
     }
-    return Builder->CreateLoad(info.Type, info.Alloca, Name.c_str());
+    return Builder->CreateLoad(info.Type, info.Alloca, symbolName(Name));
 }
 
 
@@ -509,29 +578,8 @@ llvm::Value *VarDeclAST::codegen() {
     llvm::Value *InitRes = InitVal->codegen();
     if (!InitRes) return nullptr;
 
-    // 2. Determine LLVM Type
-    llvm::Type *TargetType = nullptr;
-    if (Type == "bool") {
-        // Store booleans as 8-bit (1 byte) so they play nice with memory
-        TargetType = llvm::IntegerType::get(*TheContext, 8); 
-    }
-    else if (Type.find("int") != std::string::npos) {
-        TargetType = llvm::IntegerType::get(*TheContext, Bytes * 8);
-    } 
-    else if (Type == "char") {
-        TargetType = llvm::IntegerType::get(*TheContext, 8);
-    }
-    else if (Type.find("float") != std::string::npos) {
-        if (Bytes == 4) TargetType = llvm::Type::getFloatTy(*TheContext);
-        else TargetType = llvm::Type::getDoubleTy(*TheContext);
-    }
-    else if (Type == "string") {
-        // TargetType = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(*TheContext));
-        TargetType = llvm::PointerType::getUnqual(*TheContext);
-    }
-    else {
-        TargetType = llvm::IntegerType::get(*TheContext, 32);
-    }
+    // 2. Determine LLVM Type (booleans are stored as 8-bit, like char)
+    llvm::Type *TargetType = llvmType(variableType(Type, Bytes));
 
     // 3. INTEGER BOUNDS CHECKING (FIXED)
     if (auto *CI = llvm::dyn_cast<llvm::ConstantInt>(InitRes)) {
@@ -552,7 +600,7 @@ llvm::Value *VarDeclAST::codegen() {
             // CASE A: Boolean Check
             if (Type == "bool") {
                 if (val != 0 && val != 1) {
-                    std::cerr << "\n[Quanta Error] Invalid Boolean! Must be true(1) or false(0). Got: " << val << std::endl;
+                    diag() << "\n[Quanta Error] Invalid Boolean! Must be true(1) or false(0). Got: " << val << std::endl;
                     return nullptr;
                 }
             }
@@ -563,8 +611,8 @@ llvm::Value *VarDeclAST::codegen() {
                     int64_t maxVal = (1LL << (bits - 1)) - 1;
                     int64_t minVal = -(1LL << (bits - 1));
                     if (val > maxVal || val < minVal) {
-                        std::cerr << "\n[Quanta Error] Overflow Detected for '" << Name << "'\n";
-                        std::cerr << "  Value: " << val << " | Range: " << minVal << " to " << maxVal << "\n";
+                        diag() << "\n[Quanta Error] Overflow Detected for '" << symbolName(Name) << "'\n";
+                        diag() << "  Value: " << val << " | Range: " << minVal << " to " << maxVal << "\n";
                         return nullptr;
                     }
                 }
@@ -573,17 +621,20 @@ llvm::Value *VarDeclAST::codegen() {
     }
 
     // 4. MEMORY MANAGEMENT
-    llvm::AllocaInst *Alloca = nullptr;
-    if (NamedValues.find(Name) != NamedValues.end()) {
-        VarInfo& oldInfo = NamedValues[Name];
-        if (oldInfo.Alloca->getAllocatedType()->getPrimitiveSizeInBits() >= TargetType->getPrimitiveSizeInBits()) {
+    llvm::Value *Alloca = nullptr;
+    // An outer variable of the same name is shadowed, never overwritten
+    if (VarInfo *Old = NamedValues.lookupCurrent(Name)) {
+        VarInfo& oldInfo = *Old;
+        if (slotType(oldInfo.Alloca)->getPrimitiveSizeInBits() >= TargetType->getPrimitiveSizeInBits()) {
             Alloca = oldInfo.Alloca;
         } 
     }
-    if (!Alloca) {
+    if (!Alloca && ReplEntry) {
+        Alloca = createReplGlobal(TargetType, symbolName(Name));
+    } else if (!Alloca) {
         llvm::Function *TheFunction = Builder->GetInsertBlock()->getParent();
         llvm::IRBuilder<> TmpB(&TheFunction->getEntryBlock(), TheFunction->getEntryBlock().begin());
-        Alloca = TmpB.CreateAlloca(TargetType, nullptr, Name);
+        Alloca = TmpB.CreateAlloca(TargetType, nullptr, symbolName(Name));
     }
 
     // 5. SAFE CASTING
@@ -607,7 +658,7 @@ llvm::Value *VarDeclAST::codegen() {
     }
 
     Builder->CreateStore(FinalVal, Alloca);
-    NamedValues[Name] = {Alloca, TargetType, Type, nullptr}; 
+    NamedValues.declare(Name, {Alloca, TargetType, Type, nullptr});
     return FinalVal;
  
 }
@@ -617,40 +668,37 @@ llvm::Value *AssignmentAST::codegen() {
     llvm::Value *Val = RHS->codegen();
     if (!Val) return nullptr;
 
-    llvm::AllocaInst *Alloca = nullptr;
+    llvm::Value *Alloca = nullptr;
     llvm::Type *TargetType = nullptr;
 
     // 2. Check if variable exists
-    if (NamedValues.find(Name) == NamedValues.end()) {
+    VarInfo *Existing = NamedValues.lookup(Name);
+    if (!Existing) {
     
         TargetType = Val->getType();
         
-        // BETTER TYPE DETECTION
+        // The name type() reports, from the value's type
+        QType ValTy = typeOf(RHS, Val);
         std::string TypeName = "unknown";
-        
-        if (TargetType->isDoubleTy()) {
-            TypeName = "float";
-        } 
-        else if (TargetType->isPointerTy()) {
-            TypeName = "string"; 
-        } 
-        else if (TargetType->isIntegerTy()) {
-            int width = TargetType->getIntegerBitWidth();
-            if (width == 1) TypeName = "bool";       // Detect Bool (i1)
-            else if (width == 8) TypeName = "char";  // Detect Char (i8)
-            else TypeName = "int";                   // Default Int (i32/i64)
-        }
+        if (ValTy == QType::floating(64)) TypeName = "float";
+        else if (ValTy.Kind == QType::String) TypeName = "string";
+        else if (ValTy.Kind == QType::Int)
+            TypeName = ValTy.Bits == 1 ? "bool" : ValTy.Bits == 8 ? "char" : "int";
 
         // Create memory
-        llvm::Function *TheFunction = Builder->GetInsertBlock()->getParent();
-        llvm::IRBuilder<> TmpB(&TheFunction->getEntryBlock(), TheFunction->getEntryBlock().begin());
-        Alloca = TmpB.CreateAlloca(TargetType, nullptr, Name);
+        if (ReplEntry) {
+            Alloca = createReplGlobal(TargetType, symbolName(Name));
+        } else {
+            llvm::Function *TheFunction = Builder->GetInsertBlock()->getParent();
+            llvm::IRBuilder<> TmpB(&TheFunction->getEntryBlock(), TheFunction->getEntryBlock().begin());
+            Alloca = TmpB.CreateAlloca(TargetType, nullptr, symbolName(Name));
+        }
         
         // Save to Symbol Table with correct TypeName
-        NamedValues[Name] = {Alloca, TargetType, TypeName};
+        NamedValues.declare(Name, {Alloca, TargetType, TypeName, nullptr});
     } else {
         // --- EXISTING VARIABLE ---
-        VarInfo& info = NamedValues[Name];
+        VarInfo& info = *Existing;
         Alloca = info.Alloca;
         TargetType = info.Type;
     }
@@ -687,10 +735,9 @@ llvm::Value *BinaryExprAST::codegen() {
     llvm::Value *R = RHS->codegen();
     if (!L || !R) return nullptr;
 
-    bool LIsString = L->getType()->isPointerTy();
-    bool RIsString = R->getType()->isPointerTy();
+    QType LTy = typeOf(LHS, L), RTy = typeOf(RHS, R);
 
-    if (LIsString && RIsString) {
+    if (LTy.Kind == QType::String && RTy.Kind == QType::String) {
         if (Op == '+') {
             llvm::Value *LenL = Builder->CreateCall(getStrlenFunc(), {L}, "lenL");
             llvm::Value *LenR = Builder->CreateCall(getStrlenFunc(), {R}, "lenR");
@@ -735,27 +782,17 @@ llvm::Value *BinaryExprAST::codegen() {
     }
 
 
-    bool LIsFloat = L->getType()->isFloatingPointTy();
-    bool RIsFloat = R->getType()->isFloatingPointTy();
-
-    if (LIsFloat && !RIsFloat) {
-        R = Builder->CreateSIToFP(R, L->getType(), "cast_int_to_float");
-        RIsFloat = true;
-    } 
-    else if (!LIsFloat && RIsFloat) {
-        L = Builder->CreateSIToFP(L, R->getType(), "cast_int_to_float");
-        LIsFloat = true;
-    }
-    
-    // SAFE BITWIDTH CHECK
-    if (!LIsFloat && !RIsFloat) {
-        if (L->getType()->getIntegerBitWidth() < R->getType()->getIntegerBitWidth())
-             L = Builder->CreateIntCast(L, R->getType(), true, "grow");
-        else if (L->getType()->getIntegerBitWidth() > R->getType()->getIntegerBitWidth())
-             R = Builder->CreateIntCast(R, L->getType(), true, "grow");
+    // Both sides go straight to the operation's type: one cast at most
+    QType OpTy = arithmeticType(LTy, RTy);
+    if (OpTy.Kind == QType::Unknown) {
+        diag() << "[Quanta Error] Operator needs two numbers or two strings" << std::endl;
+        HasError = true;
+        return nullptr;
     }
+    L = convertNumber(L, LTy, OpTy);
+    R = convertNumber(R, RTy, OpTy);
 
-    bool isFloat = LIsFloat; 
+    bool isFloat = OpTy.Kind == QType::Float;
 
     switch (Op) {
         case '+': return isFloat ? Builder->CreateFAdd(L, R, "add") : Builder->CreateAdd(L, R, "add");
@@ -763,10 +800,10 @@ llvm::Value *BinaryExprAST::codegen() {
         case '*': return isFloat ? Builder->CreateFMul(L, R, "mul") : Builder->CreateMul(L, R, "mul");
         case '/': 
             if (auto *CR = llvm::dyn_cast<llvm::ConstantFP>(R)) {
-                if (CR->getValueAPF().isZero()) { std::cerr << "Error: Div by Zero\n"; return nullptr; }
+                if (CR->getValueAPF().isZero()) { diag() << "Error: Div by Zero\n"; return nullptr; }
             }
             if (auto *CI = llvm::dyn_cast<llvm::ConstantInt>(R)) {
-                if (CI->isZero()) { std::cerr << "Error: Div by Zero\n"; return nullptr; }
+                if (CI->isZero()) { diag() << "Error: Div by Zero\n"; return nullptr; }
             }
             return isFloat ? Builder->CreateFDiv(L, R, "div") : Builder->CreateSDiv(L, R, "div");
         case '<':
@@ -842,13 +879,14 @@ llvm::Value *BinaryExprAST::codegen() {
 
 llvm::Value *UpdateExprAST::codegen() {
     // 1. Find variable address
-    if (NamedValues.find(Name) == NamedValues.end())
+    VarInfo *Var = NamedValues.lookup(Name);
+    if (!Var)
         return LogErrorV("Unknown variable in update expression");
     
-    llvm::AllocaInst *V = NamedValues[Name].Alloca; // Ensure you use .Alloca
+    llvm::Value *V = Var->Alloca; // Ensure you use .Alloca
 
     // 2. Load current value
-    llvm::Value *CurVal = Builder->CreateLoad(V->getAllocatedType(), V, Name.c_str());
+    llvm::Value *CurVal = Builder->CreateLoad(slotType(V), V, symbolName(Name));
 
     // 3. Add or Sub 1
     llvm::Value *One = llvm::ConstantInt::get(CurVal->getType(), 1);
@@ -960,13 +998,14 @@ llvm::Value *PrintAST::codegen() {
 
 llvm::Value *ByteSizeAST::codegen() {
     // 1. Look up variable
-    if (NamedValues.find(Name) == NamedValues.end()) {
-        std::cerr << "[Quanta Error] Unknown variable in bytesize: " << Name << std::endl;
+    VarInfo *Var = NamedValues.lookup(Name);
+    if (!Var) {
+        diag() << "[Quanta Error] Unknown variable in bytesize: " << symbolName(Name) << std::endl;
         return nullptr;
     }
 
     // 2. Get the Type
-    llvm::Type *T = NamedValues[Name].Type;
+    llvm::Type *T = Var->Type;
     
     // 3. Calculate Size
     // getPrimitiveSizeInBits returns bits (e.g., 32 for int). Divide by 8 to get Bytes.
@@ -986,13 +1025,14 @@ llvm::Value *ByteSizeAST::codegen() {
 
 llvm::Value *TypeofAST::codegen() {
     // 1. Look up variable in Symbol Table
-    if (NamedValues.find(Name) == NamedValues.end()) {
-        std::cerr << "[Quanta Error] Unknown variable in type(): " << Name << std::endl;
+    VarInfo *Var = NamedValues.lookup(Name);
+    if (!Var) {
+        diag() << "[Quanta Error] Unknown variable in type(): " << symbolName(Name) << std::endl;
         return nullptr;
     }
 
     // 2. Retrieve the stored Type Name (e.g., "int", "float", "string")
-    std::string typeName = NamedValues[Name].TypeName;
+    std::string typeName = Var->TypeName;
 
     // 3. Create a Global String Pointer (standard string in LLVM)
     // return Builder->CreateGlobalStringPtr(typeName);
@@ -1076,6 +1116,7 @@ llvm::Value *IfExprAST::codegen() {
 // --- Generate Code for a Block { ... } ---
 llvm::Value *BlockAST::codegen() {
     llvm::Value *LastVal = nullptr;
+    ScopedSymbolTable<VarInfo>::Scope Scope(NamedValues); // Variables declared inside end with the block
     
     // Loop through every statement in the block
     for (const auto &Stmt : Statements) {
@@ -1091,34 +1132,142 @@ llvm::Value *BlockAST::codegen() {
 // --- 8. SAVE TO FILE ---
 
 
-void generateObjectCode() {
-    llvm::InitializeAllTargetInfos();
-    llvm::InitializeAllTargets();
-    llvm::InitializeAllTargetMCs();
-    llvm::InitializeAllAsmPrinters();
-    std::string TargetTriple = llvm::sys::getDefaultTargetTriple();
+bool generateObjectCode(const std::string &Filename) {
+    // Ask the backend for the final frame size of every function. It
+    // appends, so each compile starts a fresh file of its own.
+    if (StackReport) {
+        llvm::SmallString<128> Path;
+        if (llvm::sys::fs::createUniqueFile(Filename + "-%%%%%%.su", Path)) {
+            diag() << "[Codegen Error] Could not create a stack usage file next to " << Filename << std::endl;
+            return false;
+        }
+        StackUsageFile = std::string(Path);
+    }
+    if (!emitObjectFile(Filename)) {
+        if (StackReport) llvm::sys::fs::remove(StackUsageFile);
+        return false;
+    }
+    info() << "[Success] Native object file '" << Filename << "' created!" << std::endl;
+    return true;
+}
+
+static std::string TargetTriple;
+static std::unique_ptr<llvm::TargetMachine> TheTargetMachine;
+
+bool initializeBackend() {
+    if (TheTargetMachine) return true;
+    // Objects are only ever built for this machine, so only its backend is needed
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    TargetTriple = llvm::sys::getDefaultTargetTriple();
     // std::string TargetTriple = "arm64-apple-macosx15.0.0";
-    // TheModule->setTargetTriple(TargetTriple);
-    
-    
+
     std::string Error;
     auto Target = llvm::TargetRegistry::lookupTarget(TargetTriple, Error);
+    if (!Target) {
+        diag() << "[Codegen Error] " << Error << std::endl;
+        return false;
+    }
     
     auto CPU = "generic";
     auto Features = "";
     llvm::TargetOptions opt;
-    auto TargetMachine = Target->createTargetMachine(llvm::Triple(TargetTriple), CPU, Features, opt, llvm::Reloc::PIC_);
-    TheModule->setTargetTriple(llvm::Triple(TargetTriple));
-    TheModule->setDataLayout(TargetMachine->createDataLayout());
+    TheTargetMachine.reset(Target->createTargetMachine(llvm::Triple(TargetTriple), CPU, Features, opt, llvm::Reloc::PIC_));
+    return TheTargetMachine != nullptr;
+}
+
+bool emitObjectFile(const std::string &Filename) {
     std::error_code EC;
-    llvm::raw_fd_ostream dest("output.o", EC, llvm::sys::fs::OF_None);
+    llvm::raw_fd_ostream dest(Filename, EC, llvm::sys::fs::OF_None);
+    if (EC) {
+        diag() << "[Codegen Error] Could not open " << Filename << ": " << EC.message() << std::endl;
+        return false;
+    }
+    return emitObject(dest);
+}
+
+bool emitObject(llvm::raw_pwrite_stream &dest) {
+    if (!initializeBackend()) return false;
+    // Set per object: the TargetMachine outlives any one compile
+    TheTargetMachine->Options.StackUsageOutput = StackReport ? StackUsageFile : "";
+    TheModule->setTargetTriple(llvm::Triple(TargetTriple));
+    TheModule->setDataLayout(TheTargetMachine->createDataLayout());
     llvm::legacy::PassManager pass;
-    if (TargetMachine->addPassesToEmitFile(pass, dest, nullptr, llvm::CodeGenFileType::ObjectFile)) {
-        return;
+    if (TheTargetMachine->addPassesToEmitFile(pass, dest, nullptr, llvm::CodeGenFileType::ObjectFile)) {
+        return false;
     }
     pass.run(*TheModule);
     dest.flush();
-    std::cout << "[Success] Native object file 'output.o' created!" << std::endl;
+    return true;
+}
+
+void startNewModule(const std::string &Name) {
+    TheModule = std::make_unique<llvm::Module>(Name, *TheContext);
+    StringPool.clear(); // Pooled literals are globals of the old module
+}
+
+// --- REPL INPUTS ---
+// Every input is a module of its own in the one context, so types stay
+// valid from input to input. Each input may define any name again: the REPL
+// links it ahead of the earlier inputs.
+void beginReplInput(const std::string &Name) {
+    startNewModule(Name);
+    DefinedFunctions.clear();
+    PendingReplVariables.clear();
+}
+
+llvm::Function *codegenReplEntry(FunctionAST *Entry) {
+    // The session's variables, declared in this module
+    NamedValues.clear();
+    for (auto &[Name, Var] : ReplVariables) {
+        VarInfo Info = Var.Info;
+        Info.Alloca = TheModule->getOrInsertGlobal(Var.Global, Var.GlobalType);
+        NamedValues.declare(Name, Info);
+    }
+    ReplEntry = true;
+    llvm::Function *F = Entry->codegen();
+    ReplEntry = false;
+
+    NamedValues.forEachOutermost([](SymbolID Name, const VarInfo &Info) {
+        if (auto *GV = llvm::dyn_cast<llvm::GlobalVariable>(Info.Alloca))
+            PendingReplVariables[Name] = {GV->getName().str(), GV->getValueType(), Info};
+    });
+    return F;
+}
+
+void commitReplInput() {
+    for (auto &[Name, Var] : PendingReplVariables) ReplVariables[Name] = Var;
+    PendingReplVariables.clear();
+}
+
+// --- PER-FUNCTION OPTIMIZATION ---
+// The function pipeline only, so it can run while the module is still being
+// filled in. Cached analyses are dropped after each run: the next function
+// may live in a new module.
+void optimizeFunction(llvm::Function &F) {
+    static llvm::LoopAnalysisManager LAM;
+    static llvm::FunctionAnalysisManager FAM;
+    static llvm::CGSCCAnalysisManager CGAM;
+    static llvm::ModuleAnalysisManager MAM;
+    static llvm::FunctionPassManager FPM = [] {
+        llvm::PassBuilder PB;
+        PB.registerModuleAnalyses(MAM);
+        PB.registerCGSCCAnalyses(CGAM);
+        PB.registerFunctionAnalyses(FAM);
+        PB.registerLoopAnalyses(LAM);
+        PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+        llvm::FunctionPassManager P;
+        P.addPass(llvm::PromotePass());
+        P.addPass(llvm::InstCombinePass());
+        P.addPass(llvm::ReassociatePass());
+        P.addPass(llvm::GVNPass());
+        P.addPass(llvm::SimplifyCFGPass());
+        return P;
+    }();
+
+    FPM.run(F, FAM);
+    FAM.clear();
 }
 
 llvm::Value *LoopAST::codegen() {
@@ -1175,15 +1324,16 @@ llvm::Value *LoopAST::codegen() {
 // src/codegen.cpp
 llvm::Value *CallAST::codegen() {
     // 1. Look up the LLVM function
-    llvm::Function *CalleeF = TheModule->getFunction(Callee);
-    if (!CalleeF) return LogErrorV(("Undefined function: " + Callee).c_str());
+    const std::string &CalleeName = symbolName(Callee);
+    llvm::Function *CalleeF = TheModule->getFunction(CalleeName);
 
     // 2. Look up Registry Info (needed for Argument Names & Defaults)
-    bool hasRegistryInfo = (FunctionRegistry.find(Callee) != FunctionRegistry.end());
-    FunctionInfo FuncInfo;
-    if (hasRegistryInfo) {
-        FuncInfo = FunctionRegistry[Callee];
-    }
+    auto RegIt = FunctionRegistry.find(Callee);
+    const FunctionInfo *FuncInfo = RegIt != FunctionRegistry.end() ? &RegIt->second : nullptr;
+
+    // Not generated yet (--stream) or generated into an earlier module (--split)
+    if (!CalleeF && FuncInfo && FuncInfo->Decl) CalleeF = FuncInfo->Decl->codegenPrototype();
+    if (!CalleeF) return LogErrorV(("Undefined function: " + CalleeName).c_str());
 
     unsigned ExpectedCount = CalleeF->arg_size();
     
@@ -1199,13 +1349,13 @@ llvm::Value *CallAST::codegen() {
         llvm::Value *Val = Arg.Val->codegen();
         if (!Val) return nullptr;
 
-        if (!Arg.Name.empty()) {
+        if (Arg.Name != SYM_NONE) {
             // === KEYWORD ARGUMENT (rollno=30) ===
             // Find which slot index belongs to "rollno"
             int TargetIndex = -1;
-            if (hasRegistryInfo) {
-                for (unsigned i = 0; i < FuncInfo.Args.size(); ++i) {
-                    if (FuncInfo.Args[i].Name == Arg.Name) {
+            if (FuncInfo) {
+                for (unsigned i = 0; i < FuncInfo->Args.size(); ++i) {
+                    if (FuncInfo->Args[i].Name == Arg.Name) {
                         TargetIndex = i;
                         break;
                     }
@@ -1213,10 +1363,10 @@ llvm::Value *CallAST::codegen() {
             }
 
             if (TargetIndex == -1) 
-                return LogErrorV(("Unknown argument name: " + Arg.Name).c_str());
+                return LogErrorV(("Unknown argument name: " + symbolName(Arg.Name)).c_str());
 
             if (FinalArgs[TargetIndex] != nullptr)
-                return LogErrorV(("Argument '" + Arg.Name + "' provided twice.").c_str());
+                return LogErrorV(("Argument '" + symbolName(Arg.Name) + "' provided twice.").c_str());
 
             FinalArgs[TargetIndex] = Val;
         } 
@@ -1240,8 +1390,8 @@ llvm::Value *CallAST::codegen() {
     for (unsigned i = 0; i < ExpectedCount; ++i) {
         if (FinalArgs[i] == nullptr) {
             // Check if we have a default value in the registry
-            if (hasRegistryInfo && i < FuncInfo.Args.size() && FuncInfo.Args[i].DefaultValue) {
-                FinalArgs[i] = FuncInfo.Args[i].DefaultValue->codegen();
+            if (FuncInfo && i < FuncInfo->Args.size() && FuncInfo->Args[i].DefaultValue) {
+                FinalArgs[i] = FuncInfo->Args[i].DefaultValue->codegen();
             } else {
                 return LogErrorV(("Missing required argument #" + std::to_string(i+1)).c_str());
             }
@@ -1271,6 +1421,7 @@ llvm::Value *CallAST::codegen() {
     }
 
     // 5. Generate Call
+    recordCallEdge(Builder->GetInsertBlock()->getParent()->getName().str(), CalleeName);
     return Builder->CreateCall(CalleeF, FinalArgs, "calltmp");
 }
 
@@ -1278,10 +1429,10 @@ llvm::Value *CallAST::codegen() {
 
 llvm::Value *StringIndexAST::codegen() {
     // 1. Array / List Check
-    if (auto *VarAst = dynamic_cast<VariableAST*>(BaseExpr.get())) {
-        std::string name = VarAst->getName();
-        if (NamedValues.find(name) != NamedValues.end()) {
-            VarInfo &info = NamedValues[name];
+    if (auto *VarAst = llvm::dyn_cast<VariableAST>(BaseExpr)) {
+        SymbolID name = VarAst->getName();
+        if (VarInfo *Var = NamedValues.lookup(name)) {
+            VarInfo &info = *Var;
             
             if (info.Type->isArrayTy() || info.Type->isStructTy()) {
                 llvm::Value *IdxVal = IndexExpr->codegen();
@@ -1357,9 +1508,14 @@ llvm::Value *LoopOverStringAST::codegen() {
     llvm::BasicBlock *BodyBB = llvm::BasicBlock::Create(*TheContext, "loop_str_body");
     llvm::BasicBlock *AfterBB = llvm::BasicBlock::Create(*TheContext, "loop_str_after");
 
-    llvm::IRBuilder<> TmpB(&TheFunction->getEntryBlock(), TheFunction->getEntryBlock().begin());
-    llvm::AllocaInst *VarAlloca = TmpB.CreateAlloca(Builder->getInt32Ty(), nullptr, VarName);
-    TmpB.CreateStore(llvm::ConstantInt::get(Builder->getInt32Ty(), 0), VarAlloca);
+    llvm::Value *VarAlloca;
+    if (ReplEntry) {
+        VarAlloca = createReplGlobal(Builder->getInt32Ty(), symbolName(VarName));
+    } else {
+        llvm::IRBuilder<> TmpB(&TheFunction->getEntryBlock(), TheFunction->getEntryBlock().begin());
+        VarAlloca = TmpB.CreateAlloca(Builder->getInt32Ty(), nullptr, symbolName(VarName));
+        TmpB.CreateStore(llvm::ConstantInt::get(Builder->getInt32Ty(), 0), VarAlloca);
+    }
 
     Builder->CreateBr(CondBB);
 
@@ -1370,8 +1526,11 @@ llvm::Value *LoopOverStringAST::codegen() {
 
     TheFunction->insert(TheFunction->end(), BodyBB);
     Builder->SetInsertPoint(BodyBB);
-    NamedValues[VarName] = VarInfo{VarAlloca, Builder->getInt32Ty(), "int", nullptr};
-    if (!Body->codegen()) return nullptr;
+    {
+        ScopedSymbolTable<VarInfo>::Scope Scope(NamedValues); // The loop variable ends with the loop
+        NamedValues.declare(VarName, VarInfo{VarAlloca, Builder->getInt32Ty(), "int", nullptr});
+        if (!Body->codegen()) return nullptr;
+    }
     llvm::Value *Next = Builder->CreateAdd(Cur, llvm::ConstantInt::get(Builder->getInt32Ty(), 1), "next_i");
     Builder->CreateStore(Next, VarAlloca);
     Builder->CreateBr(CondBB);
@@ -1383,11 +1542,12 @@ llvm::Value *LoopOverStringAST::codegen() {
 
 llvm::Value *FixedStringDeclAST::codegen() {
     // 1. Tell the terminal we are building a safe stack string!
-    std::cout << "[Codegen] Allocating embedded stack buffer for: " << VarName << " (Size: " << Capacity << ")" << std::endl;
+    info() << "[Codegen] Allocating embedded stack buffer for: " << symbolName(VarName) << " (Size: " << Capacity << ")" << std::endl;
 
     // 2. Create the fixed-size array on the stack
     llvm::ArrayType *ArrayTy = llvm::ArrayType::get(Builder->getInt8Ty(), Capacity);
-    llvm::AllocaInst *StackBuffer = Builder->CreateAlloca(ArrayTy, nullptr, VarName + "_buffer");
+    llvm::Value *StackBuffer = ReplEntry ? createReplGlobal(ArrayTy, symbolName(VarName) + "_buffer")
+                                         : Builder->CreateAlloca(ArrayTy, nullptr, symbolName(VarName) + "_buffer");
     llvm::Value *BufferPtr = StackBuffer;
 
     // 3. Generate the giant string we want to copy
@@ -1415,12 +1575,13 @@ llvm::Value *FixedStringDeclAST::codegen() {
     Builder->CreateStore(llvm::ConstantInt::get(Builder->getInt8Ty(), 0), LastCharAddr);
 
     // 5. Save ONLY the safe buffer pointer in our Variable Registry
-    llvm::AllocaInst *VarAlloca = Builder->CreateAlloca(Builder->getPtrTy(), nullptr, VarName);
+    llvm::Value *VarAlloca = ReplEntry ? createReplGlobal(Builder->getPtrTy(), symbolName(VarName))
+                                       : Builder->CreateAlloca(Builder->getPtrTy(), nullptr, symbolName(VarName));
     
     // [CRITICAL] Store BufferPtr into the variable, NOT InitVal!
     Builder->CreateStore(BufferPtr, VarAlloca); 
     
-    NamedValues[VarName] = VarInfo{VarAlloca, Builder->getPtrTy(), "string[" + std::to_string(Capacity) + "]", nullptr};
+    NamedValues.declare(VarName, VarInfo{VarAlloca, Builder->getPtrTy(), "string[" + std::to_string(Capacity) + "]", nullptr});
 
     return BufferPtr;
 }
@@ -1443,18 +1604,16 @@ llvm::Value *ArrayExprAST::codegen() {
 
 llvm::Value *FixedArrayDeclAST::codegen() {
     // Determine Element Type
-    llvm::Type *ElementType = Builder->getInt32Ty(); 
-    if (TypeName == "float") ElementType = Builder->getDoubleTy();
-    else if (TypeName == "string") ElementType = Builder->getPtrTy();
-    else if (TypeName == "bool" || TypeName == "char") ElementType = Builder->getInt8Ty();
+    llvm::Type *ElementType = llvmType(elementType(TypeName));
 
     // Allocate Array on the Stack
     llvm::ArrayType *ArrayTy = llvm::ArrayType::get(ElementType, Size);
-    llvm::AllocaInst *ArrayAlloca = Builder->CreateAlloca(ArrayTy, nullptr, VarName);
+    llvm::Value *ArrayAlloca = ReplEntry ? createReplGlobal(ArrayTy, symbolName(VarName))
+                                         : Builder->CreateAlloca(ArrayTy, nullptr, symbolName(VarName));
 
     // Initialize Elements if provided [a, b, c]
     if (InitValue) {
-        if (auto *ArrayLit = dynamic_cast<ArrayExprAST*>(InitValue.get())) {
+        if (auto *ArrayLit = llvm::dyn_cast<ArrayExprAST>(InitValue)) {
             for (size_t i = 0; i < ArrayLit->Elements.size() && i < Size; i++) {
                 llvm::Value *Val = ArrayLit->Elements[i]->codegen();
                 if (!Val) return nullptr;
@@ -1477,16 +1636,13 @@ llvm::Value *FixedArrayDeclAST::codegen() {
         }
     }
 
-    NamedValues[VarName] = VarInfo{ArrayAlloca, ArrayTy, TypeName + "[" + std::to_string(Size) + "]", ElementType};
+    NamedValues.declare(VarName, VarInfo{ArrayAlloca, ArrayTy, TypeName + "[" + std::to_string(Size) + "]", ElementType});
     return ArrayAlloca;
 }
 
 llvm::Value *DynamicListDeclAST::codegen() {
     // Determine Element Type
-    llvm::Type *ElementType = Builder->getInt32Ty(); 
-    if (TypeName == "float") ElementType = Builder->getDoubleTy();
-    else if (TypeName == "string") ElementType = Builder->getPtrTy();
-    else if (TypeName == "bool" || TypeName == "char") ElementType = Builder->getInt8Ty();
+    llvm::Type *ElementType = llvmType(elementType(TypeName));
 
     // Struct: { ElementType*, i32 len, i32 capacity }
     llvm::StructType *ListStructTy = llvm::StructType::get(*TheContext, {
@@ -1495,7 +1651,8 @@ llvm::Value *DynamicListDeclAST::codegen() {
         Builder->getInt32Ty()
     });
 
-    llvm::AllocaInst *ListAlloca = Builder->CreateAlloca(ListStructTy, nullptr, VarName);
+    llvm::Value *ListAlloca = ReplEntry ? createReplGlobal(ListStructTy, symbolName(VarName))
+                                        : Builder->CreateAlloca(ListStructTy, nullptr, symbolName(VarName));
 
     // Calculate initial capacity & heap bytes
     int initialCap = 8;
@@ -1518,7 +1675,7 @@ llvm::Value *DynamicListDeclAST::codegen() {
 
     // Initialize from literal [x, y, z]
     if (InitValue) {
-        if (auto *ArrayLit = dynamic_cast<ArrayExprAST*>(InitValue.get())) {
+        if (auto *ArrayLit = llvm::dyn_cast<ArrayExprAST>(InitValue)) {
             for (size_t i = 0; i < ArrayLit->Elements.size(); i++) {
                 llvm::Value *Val = ArrayLit->Elements[i]->codegen();
                 if (!Val) return nullptr;
@@ -1536,18 +1693,19 @@ llvm::Value *DynamicListDeclAST::codegen() {
         }
     }
 
-    NamedValues[VarName] = VarInfo{ListAlloca, ListStructTy, TypeName + "[]", ElementType};
+    NamedValues.declare(VarName, VarInfo{ListAlloca, ListStructTy, TypeName + "[]", ElementType});
     return ListAlloca;
 }
 
 llvm::Value *IndexAssignAST::codegen() {
-    auto *VarAst = dynamic_cast<VariableAST*>(Obj.get());
+    auto *VarAst = llvm::dyn_cast<VariableAST>(Obj);
     if (!VarAst) return LogErrorV("Cannot assign to non-variable index");
     
-    std::string name = VarAst->getName();
-    if (NamedValues.find(name) == NamedValues.end()) return LogErrorV("Unknown variable in index assignment");
+    SymbolID name = VarAst->getName();
+    VarInfo *Var = NamedValues.lookup(name);
+    if (!Var) return LogErrorV("Unknown variable in index assignment");
 
-    VarInfo &info = NamedValues[name];
+    VarInfo &info = *Var;
     llvm::Value *Idx = Index->codegen();
     llvm::Value *Val = Value->codegen();
     if (!Idx || !Val) return nullptr;
@@ -1593,139 +1751,153 @@ llvm::Value *IndexAssignAST::codegen() {
     }
 }
 
+// Runtime helper behind each single-argument string method
+static llvm::Function *getStringMethodFunc(SymbolID Method) {
+    switch (Method) {
+        case SYM_ISUPPER:    return getQuantaIsUpperFunc();
+        case SYM_ISLOWER:    return getQuantaIsLowerFunc();
+        case SYM_ISALPHA:    return getQuantaIsAlphaFunc();
+        case SYM_ISDIGIT:    return getQuantaIsDigitFunc();
+        case SYM_ISSPACE:    return getQuantaIsSpaceFunc();
+        case SYM_ISALNUM:    return getQuantaIsAlnumFunc();
+        case SYM_UPPER:      return getQuantaUpperFunc();
+        case SYM_LOWER:      return getQuantaLowerFunc();
+        case SYM_REVERSE:    return getQuantaReverseFunc();
+        case SYM_STRIP:      return getQuantaStripFunc();
+        case SYM_LSTRIP:     return getQuantaLstripFunc();
+        case SYM_RSTRIP:     return getQuantaRstripFunc();
+        case SYM_CAPITALIZE: return getQuantaCapitalizeFunc();
+        case SYM_TITLE:      return getQuantaTitleFunc();
+        case SYM_FIND:       return getQuantaFindFunc();
+        case SYM_COUNT:      return getQuantaCountFunc();
+        case SYM_STARTSWITH: return getQuantaStartswithFunc();
+        case SYM_ENDSWITH:   return getQuantaEndswithFunc();
+        default:             return nullptr;
+    }
+}
+
 llvm::Value *MethodCallAST::codegen() {
     llvm::Value *ObjVal = Obj->codegen();
     if (!ObjVal) return nullptr;
 
-    auto *VarAst = dynamic_cast<VariableAST*>(Obj.get());
-    std::string ObjName = VarAst ? VarAst->getName() : "";
+    auto *VarAst = llvm::dyn_cast<VariableAST>(Obj);
+    const std::string &Method = symbolName(MethodName);
 
     // 1. DYNAMIC LIST METHODS (Heap Lists)
-    if (!ObjName.empty() && NamedValues.find(ObjName) != NamedValues.end()) {
-        VarInfo &info = NamedValues[ObjName];
-        if (info.Type->isStructTy()) {
-            if (MethodName == "push") {
-                if (Args.size() != 1) return LogErrorV("push() requires exactly 1 argument.");
-                llvm::Value *Val = Args[0]->codegen();
-                if (!Val) return nullptr;
-
-                llvm::Value *PtrField = Builder->CreateStructGEP(info.Type, info.Alloca, 0);
-                llvm::Value *LenField = Builder->CreateStructGEP(info.Type, info.Alloca, 1);
-                llvm::Value *CapField = Builder->CreateStructGEP(info.Type, info.Alloca, 2);
-
-                llvm::Value *BufferPtr = Builder->CreateLoad(Builder->getPtrTy(), PtrField, "buf_ptr");
-                llvm::Value *Len = Builder->CreateLoad(Builder->getInt32Ty(), LenField, "len");
-                llvm::Value *Cap = Builder->CreateLoad(Builder->getInt32Ty(), CapField, "cap");
-
-                llvm::Value *IsFull = Builder->CreateICmpEQ(Len, Cap, "is_full");
-
-                llvm::Function *TheFunction = Builder->GetInsertBlock()->getParent();
-                llvm::BasicBlock *ReallocBB = llvm::BasicBlock::Create(*TheContext, "realloc_bb", TheFunction);
-                llvm::BasicBlock *PushBB = llvm::BasicBlock::Create(*TheContext, "push_bb");
-
-                Builder->CreateCondBr(IsFull, ReallocBB, PushBB);
-
-                // --- REALLOC BLOCK ---
-                Builder->SetInsertPoint(ReallocBB);
-                llvm::Value *NewCap = Builder->CreateMul(Cap, llvm::ConstantInt::get(Builder->getInt32Ty(), 2), "new_cap");
-                Builder->CreateStore(NewCap, CapField);
-
-                llvm::Value *NewCap64 = Builder->CreateZExt(NewCap, Builder->getInt64Ty());
-                uint64_t elSize = info.ElementType->getPrimitiveSizeInBits() / 8;
-                if (elSize == 0 && info.ElementType->isPointerTy()) elSize = 8;
-                
-                llvm::Value *Bytes64 = Builder->CreateMul(NewCap64, llvm::ConstantInt::get(Builder->getInt64Ty(), elSize), "bytes");
+    VarInfo *Var = VarAst && Obj->Ty.Kind == QType::List ? NamedValues.lookup(VarAst->getName()) : nullptr;
+    if (Var) {
+        VarInfo &info = *Var;
+        switch (MethodName) {
+        case SYM_PUSH: {
+            if (Args.size() != 1) return LogErrorV("push() requires exactly 1 argument.");
+            llvm::Value *Val = Args[0]->codegen();
+            if (!Val) return nullptr;
+
+            llvm::Value *PtrField = Builder->CreateStructGEP(info.Type, info.Alloca, 0);
+            llvm::Value *LenField = Builder->CreateStructGEP(info.Type, info.Alloca, 1);
+            llvm::Value *CapField = Builder->CreateStructGEP(info.Type, info.Alloca, 2);
+
+            llvm::Value *BufferPtr = Builder->CreateLoad(Builder->getPtrTy(), PtrField, "buf_ptr");
+            llvm::Value *Len = Builder->CreateLoad(Builder->getInt32Ty(), LenField, "len");
+            llvm::Value *Cap = Builder->CreateLoad(Builder->getInt32Ty(), CapField, "cap");
+
+            llvm::Value *IsFull = Builder->CreateICmpEQ(Len, Cap, "is_full");
+
+            llvm::Function *TheFunction = Builder->GetInsertBlock()->getParent();
+            llvm::BasicBlock *ReallocBB = llvm::BasicBlock::Create(*TheContext, "realloc_bb", TheFunction);
+            llvm::BasicBlock *PushBB = llvm::BasicBlock::Create(*TheContext, "push_bb");
+
+            Builder->CreateCondBr(IsFull, ReallocBB, PushBB);
+
+            // --- REALLOC BLOCK ---
+            Builder->SetInsertPoint(ReallocBB);
+            llvm::Value *NewCap = Builder->CreateMul(Cap, llvm::ConstantInt::get(Builder->getInt32Ty(), 2), "new_cap");
+            Builder->CreateStore(NewCap, CapField);
+
+            llvm::Value *NewCap64 = Builder->CreateZExt(NewCap, Builder->getInt64Ty());
+            uint64_t elSize = info.ElementType->getPrimitiveSizeInBits() / 8;
+            if (elSize == 0 && info.ElementType->isPointerTy()) elSize = 8;
+            
+            llvm::Value *Bytes64 = Builder->CreateMul(NewCap64, llvm::ConstantInt::get(Builder->getInt64Ty(), elSize), "bytes");
 
-                llvm::Value *NewBufferPtr = Builder->CreateCall(getReallocFunc(), {BufferPtr, Bytes64}, "new_buffer");
-                Builder->CreateStore(NewBufferPtr, PtrField);
-                
-                // Re-track memory for AutoFree feature (if realloc moved it)
-                trackForAutoFree(NewBufferPtr); 
-                
-                Builder->CreateBr(PushBB);
+            llvm::Value *NewBufferPtr = Builder->CreateCall(getReallocFunc(), {BufferPtr, Bytes64}, "new_buffer");
+            Builder->CreateStore(NewBufferPtr, PtrField);
+            
+            // Re-track memory for AutoFree feature (if realloc moved it)
+            trackForAutoFree(NewBufferPtr); 
+            
+            Builder->CreateBr(PushBB);
 
-                // --- PUSH BLOCK ---
-                TheFunction->insert(TheFunction->end(), PushBB);
-                Builder->SetInsertPoint(PushBB);
+            // --- PUSH BLOCK ---
+            TheFunction->insert(TheFunction->end(), PushBB);
+            Builder->SetInsertPoint(PushBB);
 
-                llvm::Value *FinalBufferPtr = Builder->CreateLoad(Builder->getPtrTy(), PtrField);
-                llvm::Value *IdxGEP = Builder->CreateGEP(info.ElementType, FinalBufferPtr, Len, "push_idx");
-                Builder->CreateStore(Val, IdxGEP);
+            llvm::Value *FinalBufferPtr = Builder->CreateLoad(Builder->getPtrTy(), PtrField);
+            llvm::Value *IdxGEP = Builder->CreateGEP(info.ElementType, FinalBufferPtr, Len, "push_idx");
+            Builder->CreateStore(Val, IdxGEP);
 
-                llvm::Value *NewLen = Builder->CreateAdd(Len, llvm::ConstantInt::get(Builder->getInt32Ty(), 1), "new_len");
-                Builder->CreateStore(NewLen, LenField);
+            llvm::Value *NewLen = Builder->CreateAdd(Len, llvm::ConstantInt::get(Builder->getInt32Ty(), 1), "new_len");
+            Builder->CreateStore(NewLen, LenField);
 
-                return llvm::Constant::getNullValue(Builder->getDoubleTy());
-            }
-            else if (MethodName == "pop") {
-                llvm::Value *LenField = Builder->CreateStructGEP(info.Type, info.Alloca, 1);
-                llvm::Value *Len = Builder->CreateLoad(Builder->getInt32Ty(), LenField, "len");
-                
-                llvm::Value *NewLen = Builder->CreateSub(Len, llvm::ConstantInt::get(Builder->getInt32Ty(), 1), "new_len");
-                Builder->CreateStore(NewLen, LenField);
-                
-                llvm::Value *PtrField = Builder->CreateStructGEP(info.Type, info.Alloca, 0);
-                llvm::Value *BufferPtr = Builder->CreateLoad(Builder->getPtrTy(), PtrField, "buf_ptr");
-                llvm::Value *IdxGEP = Builder->CreateGEP(info.ElementType, BufferPtr, NewLen, "pop_idx");
-                return Builder->CreateLoad(info.ElementType, IdxGEP, "pop_val");
-            }
-            else if (MethodName == "len") {
-                llvm::Value *LenField = Builder->CreateStructGEP(info.Type, info.Alloca, 1);
-                return Builder->CreateLoad(Builder->getInt32Ty(), LenField, "len");
-            }
-            else if (MethodName == "clear") {
-                llvm::Value *LenField = Builder->CreateStructGEP(info.Type, info.Alloca, 1);
-                Builder->CreateStore(llvm::ConstantInt::get(Builder->getInt32Ty(), 0), LenField);
-                return llvm::Constant::getNullValue(Builder->getDoubleTy());
-            }
+            return llvm::Constant::getNullValue(Builder->getDoubleTy());
+        }
+        case SYM_POP: {
+            llvm::Value *LenField = Builder->CreateStructGEP(info.Type, info.Alloca, 1);
+            llvm::Value *Len = Builder->CreateLoad(Builder->getInt32Ty(), LenField, "len");
+            
+            llvm::Value *NewLen = Builder->CreateSub(Len, llvm::ConstantInt::get(Builder->getInt32Ty(), 1), "new_len");
+            Builder->CreateStore(NewLen, LenField);
+            
+            llvm::Value *PtrField = Builder->CreateStructGEP(info.Type, info.Alloca, 0);
+            llvm::Value *BufferPtr = Builder->CreateLoad(Builder->getPtrTy(), PtrField, "buf_ptr");
+            llvm::Value *IdxGEP = Builder->CreateGEP(info.ElementType, BufferPtr, NewLen, "pop_idx");
+            return Builder->CreateLoad(info.ElementType, IdxGEP, "pop_val");
+        }
+        case SYM_LEN: {
+            llvm::Value *LenField = Builder->CreateStructGEP(info.Type, info.Alloca, 1);
+            return Builder->CreateLoad(Builder->getInt32Ty(), LenField, "len");
+        }
+        case SYM_CLEAR: {
+            llvm::Value *LenField = Builder->CreateStructGEP(info.Type, info.Alloca, 1);
+            Builder->CreateStore(llvm::ConstantInt::get(Builder->getInt32Ty(), 0), LenField);
+            return llvm::Constant::getNullValue(Builder->getDoubleTy());
+        }
+        default:
+            break;
         }
     }
 
     // 2. STRING NATIVE METHODS
-    if (ObjVal->getType()->isPointerTy()) {
-        if (MethodName == "len") {
+    if (typeOf(Obj, ObjVal).Kind == QType::String) {
+        switch (MethodName) {
+        case SYM_LEN: {
             llvm::Value *Len64 = Builder->CreateCall(getStrlenFunc(), {ObjVal}, "len_val");
             return Builder->CreateIntCast(Len64, Builder->getInt32Ty(), false, "len_32");
         }
-        else if (MethodName == "isupper") return Builder->CreateCall(getQuantaIsUpperFunc(), {ObjVal}, "isup_res");
-        else if (MethodName == "islower") return Builder->CreateCall(getQuantaIsLowerFunc(), {ObjVal}, "islow_res");
-        else if (MethodName == "isalpha") return Builder->CreateCall(getQuantaIsAlphaFunc(), {ObjVal}, "isalpha_res");
-        else if (MethodName == "isdigit") return Builder->CreateCall(getQuantaIsDigitFunc(), {ObjVal}, "isdigit_res");
-        else if (MethodName == "isspace") return Builder->CreateCall(getQuantaIsSpaceFunc(), {ObjVal}, "isspace_res");
-        else if (MethodName == "isalnum") return Builder->CreateCall(getQuantaIsAlnumFunc(), {ObjVal}, "isalnum_res");
+
+        // Predicates (return i32)
+        case SYM_ISUPPER: case SYM_ISLOWER: case SYM_ISALPHA:
+        case SYM_ISDIGIT: case SYM_ISSPACE: case SYM_ISALNUM:
+            return Builder->CreateCall(getStringMethodFunc(MethodName), {ObjVal}, Method + "_res");
 
         // String Modifiers (Retain trackForAutoFree buffer)
-        else if (MethodName == "upper" || MethodName == "lower" || MethodName == "reverse" ||
-                 MethodName == "strip" || MethodName == "lstrip" || MethodName == "rstrip" ||
-                 MethodName == "capitalize" || MethodName == "title") {
-            
-            llvm::Value *NewStr = nullptr;
-            if (MethodName == "upper")        NewStr = Builder->CreateCall(getQuantaUpperFunc(), {ObjVal}, "up_res");
-            else if (MethodName == "lower")   NewStr = Builder->CreateCall(getQuantaLowerFunc(), {ObjVal}, "low_res");
-            else if (MethodName == "reverse") NewStr = Builder->CreateCall(getQuantaReverseFunc(), {ObjVal}, "rev_res");
-            else if (MethodName == "strip")   NewStr = Builder->CreateCall(getQuantaStripFunc(), {ObjVal}, "strip_res");
-            else if (MethodName == "lstrip")  NewStr = Builder->CreateCall(getQuantaLstripFunc(), {ObjVal}, "lstrip_res");
-            else if (MethodName == "rstrip")  NewStr = Builder->CreateCall(getQuantaRstripFunc(), {ObjVal}, "rstrip_res");
-            else if (MethodName == "capitalize") NewStr = Builder->CreateCall(getQuantaCapitalizeFunc(), {ObjVal}, "cap_res");
-            else if (MethodName == "title")   NewStr = Builder->CreateCall(getQuantaTitleFunc(), {ObjVal}, "title_res");
-            if (NewStr) trackForAutoFree(NewStr);
+        case SYM_UPPER: case SYM_LOWER: case SYM_REVERSE: case SYM_STRIP:
+        case SYM_LSTRIP: case SYM_RSTRIP: case SYM_CAPITALIZE: case SYM_TITLE: {
+            llvm::Value *NewStr = Builder->CreateCall(getStringMethodFunc(MethodName), {ObjVal}, Method + "_res");
+            trackForAutoFree(NewStr);
             return NewStr;
         }
 
         // 2 Argument Modifiers
-        else if (MethodName == "find" || MethodName == "count" || MethodName == "startswith" || MethodName == "endswith") {
-            if (Args.size() != 1) return LogErrorV((MethodName + " requires exactly 1 argument.").c_str());
+        case SYM_FIND: case SYM_COUNT: case SYM_STARTSWITH: case SYM_ENDSWITH: {
+            if (Args.size() != 1) return LogErrorV((Method + " requires exactly 1 argument.").c_str());
             llvm::Value *SubVal = Args[0]->codegen();
             if (!SubVal || !SubVal->getType()->isPointerTy()) return LogErrorV("Expected a string argument");
-            
-            if (MethodName == "find")       return Builder->CreateCall(getQuantaFindFunc(), {ObjVal, SubVal}, "find_res");
-            else if (MethodName == "count")      return Builder->CreateCall(getQuantaCountFunc(), {ObjVal, SubVal}, "count_res");
-            else if (MethodName == "startswith") return Builder->CreateCall(getQuantaStartswithFunc(), {ObjVal, SubVal}, "startswith_res");
-            else if (MethodName == "endswith")   return Builder->CreateCall(getQuantaEndswithFunc(), {ObjVal, SubVal}, "endswith_res");
+            return Builder->CreateCall(getStringMethodFunc(MethodName), {ObjVal, SubVal}, Method + "_res");
         }
 
         // 3 Argument Modifier
-        else if (MethodName == "replace") {
+        case SYM_REPLACE: {
             if (Args.size() != 2) return LogErrorV("replace() requires exactly 2 arguments");
             llvm::Value *OldVal = Args[0]->codegen();
             llvm::Value *NewVal = Args[1]->codegen();
@@ -1736,7 +1908,11 @@ llvm::Value *MethodCallAST::codegen() {
             trackForAutoFree(NewStr);
             return NewStr;
         }
+
+        default:
+            break;
+        }
     }
     
-    return LogErrorV(("Unsupported method '" + MethodName + "' on object").c_str());
-}
\ No newline at end of file
+    return LogErrorV(("Unsupported method '" + Method + "' on object").c_str());
+}
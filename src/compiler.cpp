@@ -0,0 +1,129 @@
+#include "../include/quanta.h"
+#include "../include/quanta_compiler.h"
+#include "../include/quanta_runtime.h"
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/Mangling.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include <mutex>
+#include <sstream>
+
+extern std::unique_ptr<llvm::LLVMContext> TheContext;
+extern std::unique_ptr<llvm::Module> TheModule;
+extern std::unique_ptr<llvm::IRBuilder<>> Builder;
+
+namespace quanta {
+
+static std::mutex CompileLock;
+
+// One API call: holds the compile lock, collects diag() and drops info()
+class CompileSession {
+    std::lock_guard<std::mutex> Guard{CompileLock};
+    std::ostringstream Diag, Info;
+    std::ostream *SavedDiag, *SavedInfo;
+
+public:
+    CompileSession() : SavedDiag(setDiagnosticStream(&Diag)), SavedInfo(setInfoStream(&Info)) {}
+    ~CompileSession() {
+        setDiagnosticStream(SavedDiag);
+        setInfoStream(SavedInfo);
+    }
+    std::string diagnostics() const { return Diag.str(); }
+};
+
+// Parse and generate the whole program into TheModule. False if anything
+// was reported.
+static bool compileModule(std::string_view Source, const Options &Opts) {
+    initializeOperators();
+    RootDir = Opts.ImportDir;
+    if (!RootDir.empty() && RootDir.back() != '/' && RootDir.back() != '\\') RootDir += '/';
+    initializeModule();
+
+    Lexer lexer(Source);
+    ProgramAST program = parse(lexer);
+    if (HasError) return false;
+
+    for (FunctionAST *func : program.functions) {
+        llvm::Function *F = func->codegen();
+        if (!F) {
+            diag() << "[ERROR] Code Generation failed for function: " << symbolName(func->getName()) << std::endl;
+            return false;
+        }
+        if (Opts.Optimize) optimizeFunction(*F);
+    }
+    return !HasError;
+}
+
+ObjectResult compileToObject(std::string_view Source, const Options &Opts) {
+    CompileSession Session;
+    ObjectResult Result;
+    if (compileModule(Source, Opts)) {
+        llvm::SmallVector<char, 0> Buffer;
+        llvm::raw_svector_ostream OS(Buffer);
+        if (emitObject(OS))
+            Result.Object = llvm::MemoryBuffer::getMemBufferCopy(llvm::StringRef(Buffer.data(), Buffer.size()), "quanta.o");
+    }
+    Result.Diagnostics = Session.diagnostics();
+    return Result;
+}
+
+// --- JIT ---
+// libc comes from the host process. The runtime is defined by address: it
+// is linked into the host, but its symbols need not be exported.
+llvm::Expected<std::unique_ptr<llvm::orc::LLJIT>> createJIT() {
+    auto JIT = llvm::orc::LLJITBuilder().create();
+    if (!JIT) return JIT.takeError();
+    llvm::orc::JITDylib &Main = (*JIT)->getMainJITDylib();
+    const llvm::DataLayout &DL = (*JIT)->getDataLayout();
+
+    auto Process = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(DL.getGlobalPrefix());
+    if (!Process) return Process.takeError();
+    Main.addGenerator(std::move(*Process));
+
+    llvm::orc::MangleAndInterner Mangle((*JIT)->getExecutionSession(), DL);
+    llvm::orc::SymbolMap Runtime;
+#define QUANTA_DEFINE_RUNTIME(Name) \
+    Runtime[Mangle(#Name)] = {llvm::orc::ExecutorAddr::fromPtr(&Name), llvm::JITSymbolFlags::Exported};
+    QUANTA_RUNTIME(QUANTA_DEFINE_RUNTIME)
+#undef QUANTA_DEFINE_RUNTIME
+    if (llvm::Error Err = Main.define(llvm::orc::absoluteSymbols(std::move(Runtime)))) return std::move(Err);
+    return JIT;
+}
+
+JITResult compileToJIT(std::string_view Source, const Options &Opts) {
+    CompileSession Session;
+    JITResult Result;
+    if (compileModule(Source, Opts) && initializeBackend()) {
+        auto JIT = createJIT();
+        llvm::Error Err = JIT.takeError();
+        if (!Err) {
+            // The module takes its context along; the next compile makes new ones
+            Builder.reset();
+            TheModule->setDataLayout((*JIT)->getDataLayout());
+            Err = (*JIT)->addIRModule(llvm::orc::ThreadSafeModule(std::move(TheModule), std::move(TheContext)));
+        }
+        // Compile now, so backend errors are reported here rather than on first use
+        if (!Err) {
+            auto Main = (*JIT)->lookup(symbolName(SYM_MAIN));
+            Err = Main.takeError();
+        }
+        if (Err) diag() << "[Codegen Error] " << llvm::toString(std::move(Err)) << std::endl;
+        else Result.Program = std::make_unique<JITProgram>(std::move(*JIT));
+    }
+    Result.Diagnostics = Session.diagnostics();
+    return Result;
+}
+
+void *JITProgram::lookup(const std::string &Name) const {
+    auto Addr = JIT->lookup(Name);
+    if (!Addr) {
+        llvm::consumeError(Addr.takeError());
+        return nullptr;
+    }
+    return Addr->toPtr<void*>();
+}
+
+} // namespace quanta
@@ -0,0 +1,434 @@
+#include "../include/quanta.h"
+#include "../include/quanta_runtime.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// --- CONSTANT FOLDING ---
+// One walk over a function body, before it is typed and generated. Whatever
+// codegen would compute from literals alone is computed here instead, with
+// codegen's own rules (operand promotion, wrapping, ordered float compares),
+// so the IR and tier 0 see a literal and 'if (DEBUG == 1)' costs no blocks.
+// Anything codegen reports (division by a literal zero, an overflowing
+// declaration) is left as it is, so it is still reported there. String
+// methods and slices of literals run the runtime's own functions, so the
+// result is the program's to the byte and costs it no allocation. Calls to
+// 'const' functions with literal arguments are run by tier 0 (interp.cpp).
+
+namespace {
+
+// --- 1. VALUES ---
+
+// A literal as codegen emits it
+struct Constant {
+    QType Ty;      // Unknown when the node is not a literal
+    int64_t I = 0; // Ints: sign-extended from Ty.Bits, except i1 which is 0 or 1
+    double F = 0;
+    const std::string *S = nullptr;
+};
+
+int64_t wrap(int64_t V, unsigned Bits) {
+    if (Bits == 1) return V & 1;
+    if (Bits >= 64) return V;
+    return (int64_t)((uint64_t)V << (64 - Bits)) >> (64 - Bits);
+}
+
+// As the IR sign-extends it (i1 'true' is -1)
+int64_t signedValue(const Constant &C) { return C.Ty.Bits == 1 ? -C.I : C.I; }
+
+double floatValue(const Constant &C) {
+    return C.Ty.Kind == QType::Float ? C.F : (double)signedValue(C);
+}
+
+Constant constantOf(ASTNode *N) {
+    Constant C;
+    if (auto *Num = llvm::dyn_cast<NumberAST>(N)) {
+        C.Ty = QType::integer(Num->Bits);
+        C.I = wrap(Num->Val, Num->Bits);
+    } else if (auto *B = llvm::dyn_cast<BoolAST>(N)) {
+        C.Ty = QType::integer(1);
+        C.I = B->Val;
+    } else if (auto *Ch = llvm::dyn_cast<CharAST>(N)) {
+        C.Ty = QType::integer(8);
+        C.I = (int8_t)Ch->Val;
+    } else if (auto *Fl = llvm::dyn_cast<FloatAST>(N)) {
+        C.Ty = QType::floating(64);
+        C.F = Fl->Val;
+    } else if (auto *Str = llvm::dyn_cast<StringAST>(N)) {
+        C.Ty = QType::string();
+        C.S = &Str->val;
+    }
+    return C;
+}
+
+bool isComparison(char Op) {
+    return Op == '<' || Op == '>' || Op == TOK_EQ || Op == TOK_NEQ || Op == TOK_LEQ || Op == TOK_GEQ;
+}
+
+// Every statement after this one is unreachable
+bool endsInReturn(ASTNode *N) {
+    if (llvm::isa<ReturnAST>(N)) return true;
+    auto *B = llvm::dyn_cast<BlockAST>(N);
+    return B && !B->Statements.empty() && endsInReturn(B->Statements.back());
+}
+
+bool returnsNewString(ASTNode *N) {
+    if (llvm::isa<StringSliceAST>(N)) return true;
+    if (auto *Call = llvm::dyn_cast<CallAST>(N)) {
+        auto It = FunctionRegistry.find(Call->Callee);
+        return It != FunctionRegistry.end() && It->second.Decl &&
+               returnType(It->second.Decl->ReturnType).Kind == QType::String;
+    }
+    auto *M = llvm::dyn_cast<MethodCallAST>(N);
+    if (!M) return false;
+    switch (M->MethodName) {
+    case SYM_UPPER: case SYM_LOWER: case SYM_REVERSE: case SYM_STRIP: case SYM_LSTRIP:
+    case SYM_RSTRIP: case SYM_CAPITALIZE: case SYM_TITLE: case SYM_REPLACE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// --- 2. DEFINITIONS ---
+// How many times each name is declared or written in the body. A variable
+// defined exactly once, by its declaration, holds that value wherever it is
+// in scope.
+class DefinitionCounter : public ASTVisitor<DefinitionCounter> {
+public:
+    llvm::DenseMap<SymbolID, unsigned> Count;
+
+    void define(SymbolID Name) { ++Count[Name]; }
+    void defineObject(ASTNode *Obj) {
+        if (auto *Var = llvm::dyn_cast<VariableAST>(Obj)) define(Var->Name);
+    }
+
+    void visitVarDecl(VarDeclAST *N) { define(N->Name); visitNode(N); }
+    void visitAssignment(AssignmentAST *N) { define(N->Name); visitNode(N); }
+    void visitUpdateExpr(UpdateExprAST *N) { define(N->Name); }
+    void visitFixedStringDecl(FixedStringDeclAST *N) { define(N->VarName); visitNode(N); }
+    void visitFixedArrayDecl(FixedArrayDeclAST *N) { define(N->VarName); visitNode(N); }
+    void visitDynamicListDecl(DynamicListDeclAST *N) { define(N->VarName); visitNode(N); }
+    void visitLoopOverString(LoopOverStringAST *N) { define(N->VarName); visitNode(N); }
+    // Writes through the variable (string methods return a new string)
+    void visitIndexAssign(IndexAssignAST *N) { defineObject(N->Obj); visitNode(N); }
+};
+
+// --- 3. THE PASS ---
+// Each visit returns what takes the node's place: itself, a literal, the
+// arm of an if that is taken, or null for a statement that goes away.
+class ConstantFolder : public ASTVisitor<ConstantFolder, ASTNode*> {
+    ASTArena &Arena;
+    llvm::DenseMap<SymbolID, unsigned> Definitions;
+    ScopedSymbolTable<ASTNode*> Known; // Variables whose every read is this literal
+
+    void fold(ASTNode *&Slot) {
+        if (Slot) Slot = visit(Slot);
+    }
+
+    // Method and slice results (and what a string function returns) may be
+    // the program's own heap strings, which it may write into (s[0] = 'x');
+    // where one is stored, only its operands are folded, so it keeps its copy
+    void foldStored(ASTNode *&Slot) {
+        if (!Slot || !returnsNewString(Slot)) return fold(Slot);
+        if (auto *Call = llvm::dyn_cast<CallAST>(Slot)) foldArguments(Call);
+        else visitNode(Slot);
+    }
+    void foldArguments(CallAST *N) {
+        for (CallArg &Arg : N->Args) foldStored(Arg.Val);
+    }
+
+    // The list is replaced whole at the end: a 'const' call evaluated on the
+    // way may run this very body
+    void foldStatements(std::vector<ASTNode*> &List) {
+        std::vector<ASTNode*> Kept;
+        Kept.reserve(List.size());
+        for (ASTNode *Stmt : List) {
+            if (!(Stmt = visit(Stmt))) continue;
+            Kept.push_back(Stmt);
+            if (endsInReturn(Stmt)) break;
+        }
+        List = std::move(Kept);
+    }
+
+    ASTNode *literal(const Constant &C) {
+        if (C.Ty.Kind == QType::Float) return Arena.make<FloatAST>(C.F);
+        if (C.Ty.Bits == 1) return Arena.make<BoolAST>(C.I != 0);
+        return Arena.make<NumberAST>(C.I, C.Ty.Bits);
+    }
+    ASTNode *integer(int64_t V, unsigned Bits) {
+        Constant C;
+        C.Ty = QType::integer(Bits);
+        C.I = wrap(V, Bits);
+        return literal(C);
+    }
+    ASTNode *truth(bool V) { return integer(V, 32); } // Comparisons give an i32 0 or 1
+    // A string the runtime returned, as a literal
+    ASTNode *text(char *Heap) {
+        ASTNode *Str = Arena.make<StringAST>(Heap);
+        std::free(Heap);
+        return Str;
+    }
+
+    // What a read of the declared variable gives, if it is known
+    ASTNode *storedValue(VarDeclAST *N) {
+        Constant Init = constantOf(N->InitVal);
+        QType T = variableType(N->Type, N->Bytes);
+        if (T.Kind == QType::String)
+            return Init.Ty.Kind == QType::String ? N->InitVal : nullptr;
+        // The conversions VarDeclAST::codegen() applies: float4 and float to
+        // int are left to it
+        if (T == QType::floating(64) && Init.Ty.isNumber()) {
+            Constant C;
+            C.Ty = T;
+            C.F = floatValue(Init);
+            return literal(C);
+        }
+        if (T.Kind != QType::Int || Init.Ty.Kind != QType::Int) return nullptr;
+
+        int64_t V = Init.I; // A bool is zero-extended
+        if (N->Type == "bool") {
+            if (V != 0 && V != 1) return nullptr;
+        } else if (N->Type.find("int") != std::string::npos && T.Bits < 64) {
+            if (V != wrap(V, T.Bits)) return nullptr; // Codegen reports the overflow
+        }
+        return integer(V, T.Bits);
+    }
+
+public:
+    explicit ConstantFolder(ASTArena &Arena) : Arena(Arena) {}
+
+    void run(FunctionAST *F) {
+        DefinitionCounter Counter;
+        for (const FuncArg &Arg : F->Args) Counter.define(Arg.Name);
+        for (ASTNode *Stmt : F->Body) Counter.visit(Stmt);
+        Definitions = std::move(Counter.Count);
+        foldStatements(F->Body);
+    }
+
+    ASTNode *visitNode(ASTNode *N) {
+        forEachChild(N, [this](ASTNode *&Child) { fold(Child); });
+        return N;
+    }
+
+    // --- Variables ---
+    ASTNode *visitVariable(VariableAST *N) {
+        ASTNode **Value = Known.lookup(N->Name);
+        return Value ? *Value : N;
+    }
+
+    ASTNode *visitVarDecl(VarDeclAST *N) {
+        foldStored(N->InitVal);
+        if (Definitions.lookup(N->Name) == 1)
+            if (ASTNode *Value = storedValue(N)) Known.declare(N->Name, Value);
+        return N;
+    }
+
+    ASTNode *visitAssignment(AssignmentAST *N) {
+        foldStored(N->RHS);
+        return N;
+    }
+
+    ASTNode *visitIndexAssign(IndexAssignAST *N) {
+        fold(N->Obj);
+        fold(N->Index);
+        foldStored(N->Value);
+        return N;
+    }
+
+    // --- Expressions ---
+    ASTNode *visitCall(CallAST *N) {
+        foldArguments(N);
+        auto It = FunctionRegistry.find(N->Callee);
+        if (It == FunctionRegistry.end() || !It->second.Decl || !It->second.Decl->IsConst) return N;
+        for (CallArg &Arg : N->Args)
+            if (constantOf(Arg.Val).Ty.Kind == QType::Unknown) return N;
+        ASTNode *Value = evaluateConstCall(N, Arena);
+        return Value ? Value : N;
+    }
+
+    ASTNode *visitArrayExpr(ArrayExprAST *N) {
+        for (ASTNode *&Element : N->Elements) foldStored(Element);
+        return N;
+    }
+
+    ASTNode *visitBinaryExpr(BinaryExprAST *N) {
+        fold(N->LHS);
+        fold(N->RHS);
+        Constant L = constantOf(N->LHS), R = constantOf(N->RHS);
+        char Op = N->Op;
+
+        // Literal strings compare as strcmp() would; joining them allocates,
+        // so '+' stays
+        if (L.Ty.Kind == QType::String && R.Ty.Kind == QType::String) {
+            if (!isComparison(Op)) return N;
+            int Cmp = std::strcmp(L.S->c_str(), R.S->c_str());
+            switch (Op) {
+            case TOK_EQ:  return truth(Cmp == 0);
+            case TOK_NEQ: return truth(Cmp != 0);
+            case '<':     return truth(Cmp < 0);
+            case '>':     return truth(Cmp > 0);
+            case TOK_LEQ: return truth(Cmp <= 0);
+            default:      return truth(Cmp >= 0);
+            }
+        }
+
+        QType OpTy = arithmeticType(L.Ty, R.Ty);
+        if (OpTy == QType::floating(64)) {
+            double A = floatValue(L), B = floatValue(R);
+            Constant C;
+            C.Ty = OpTy;
+            switch (Op) {
+            case '+': C.F = A + B; return literal(C);
+            case '-': C.F = A - B; return literal(C);
+            case '*': C.F = A * B; return literal(C);
+            case '/':
+                if (B == 0) return N; // Codegen reports the division by zero
+                C.F = A / B;
+                return literal(C);
+            case '%': C.F = std::fmod(A, B); return literal(C);
+            // Ordered: anything against a NaN is false, != included
+            case '<':     return truth(A < B);
+            case '>':     return truth(A > B);
+            case TOK_LEQ: return truth(A <= B);
+            case TOK_GEQ: return truth(A >= B);
+            case TOK_EQ:  return truth(A == B);
+            case TOK_NEQ: return truth(A < B || A > B);
+            default:      return N;
+            }
+        }
+        if (OpTy.Kind != QType::Int) return N;
+
+        unsigned Bits = OpTy.Bits;
+        int64_t A = signedValue(L), B = signedValue(R);
+        switch (Op) {
+        case '+': return integer((int64_t)((uint64_t)A + (uint64_t)B), Bits);
+        case '-': return integer((int64_t)((uint64_t)A - (uint64_t)B), Bits);
+        case '*': return integer((int64_t)((uint64_t)A * (uint64_t)B), Bits);
+        case '/':
+        case '%': {
+            // Division by zero is reported by codegen; MIN / -1 has no value
+            int64_t Min = Bits >= 64 ? INT64_MIN : -(int64_t(1) << (Bits - 1));
+            if (B == 0 || (B == -1 && A == Min)) return N;
+            return integer(Op == '/' ? A / B : A % B, Bits);
+        }
+        case '<':     return truth(A < B);
+        case '>':     return truth(A > B);
+        case TOK_LEQ: return truth(A <= B);
+        case TOK_GEQ: return truth(A >= B);
+        case TOK_EQ:  return truth(A == B);
+        case TOK_NEQ: return truth(A != B);
+        default:      return N;
+        }
+    }
+
+    ASTNode *visitStringSlice(StringSliceAST *N) {
+        visitNode(N);
+        auto *Base = llvm::dyn_cast<StringAST>(N->BaseExpr);
+        if (!Base || !N->StartExpr || !N->EndExpr) return N;
+        Constant Start = constantOf(N->StartExpr), End = constantOf(N->EndExpr);
+        Constant Step;
+        Step.Ty = QType::integer(32);
+        Step.I = 1;
+        if (N->StepExpr) Step = constantOf(N->StepExpr);
+        if (Start.Ty.Kind != QType::Int || End.Ty.Kind != QType::Int || Step.Ty.Kind != QType::Int) return N;
+        // Each bound is passed as an i32
+        return text(quanta_slice(Base->val.c_str(), (int)wrap(signedValue(Start), 32),
+                                 (int)wrap(signedValue(End), 32), (int)wrap(signedValue(Step), 32)));
+    }
+
+    ASTNode *visitMethodCall(MethodCallAST *N) {
+        visitNode(N);
+        auto *Obj = llvm::dyn_cast<StringAST>(N->Obj);
+        if (!Obj) return N;
+        std::vector<const char*> Args;
+        for (ASTNode *Arg : N->Args) {
+            auto *Str = llvm::dyn_cast<StringAST>(Arg);
+            if (!Str) return N;
+            Args.push_back(Str->val.c_str());
+        }
+        const char *S = Obj->val.c_str();
+
+        switch (N->MethodName) {
+        case SYM_LEN:        return integer((int64_t)std::strlen(S), 32);
+        case SYM_ISUPPER:    return integer(quanta_isupper(S), 32);
+        case SYM_ISLOWER:    return integer(quanta_islower(S), 32);
+        case SYM_ISALPHA:    return integer(quanta_isalpha(S), 32);
+        case SYM_ISDIGIT:    return integer(quanta_isdigit(S), 32);
+        case SYM_ISSPACE:    return integer(quanta_isspace(S), 32);
+        case SYM_ISALNUM:    return integer(quanta_isalnum(S), 32);
+        case SYM_UPPER:      return text(quanta_upper(S));
+        case SYM_LOWER:      return text(quanta_lower(S));
+        case SYM_REVERSE:    return text(quanta_reverse(S));
+        case SYM_STRIP:      return text(quanta_strip(S));
+        case SYM_LSTRIP:     return text(quanta_lstrip(S));
+        case SYM_RSTRIP:     return text(quanta_rstrip(S));
+        case SYM_CAPITALIZE: return text(quanta_capitalize(S));
+        case SYM_TITLE:      return text(quanta_title(S));
+        default:             break;
+        }
+        // Codegen reports a wrong argument count
+        if (Args.size() == 1) {
+            switch (N->MethodName) {
+            case SYM_FIND:       return integer(quanta_find(S, Args[0]), 32);
+            case SYM_COUNT:      return integer(quanta_count(S, Args[0]), 32);
+            case SYM_STARTSWITH: return integer(quanta_startswith(S, Args[0]), 32);
+            case SYM_ENDSWITH:   return integer(quanta_endswith(S, Args[0]), 32);
+            default:             break;
+            }
+        }
+        if (Args.size() == 2 && N->MethodName == SYM_REPLACE)
+            return text(quanta_replace(S, Args[0], Args[1]));
+        return N;
+    }
+
+    // --- Control flow ---
+    ASTNode *visitBlock(BlockAST *N) {
+        ScopedSymbolTable<ASTNode*>::Scope Scope(Known);
+        foldStatements(N->Statements);
+        return N;
+    }
+
+    // The taken arm replaces the whole if; with no arm taken it goes away
+    ASTNode *visitIfExpr(IfExprAST *N) {
+        fold(N->Cond);
+        // IfExprAST::codegen() tests integers and doubles against zero
+        Constant Cond = constantOf(N->Cond);
+        if (Cond.Ty.Kind == QType::Int || Cond.Ty.Kind == QType::Float) {
+            bool Taken = Cond.Ty.Kind == QType::Int ? Cond.I != 0 : (Cond.F < 0 || Cond.F > 0);
+            ASTNode *Arm = Taken ? N->Then : N->Else;
+            return Arm ? visit(Arm) : nullptr;
+        }
+        fold(N->Then);
+        fold(N->Else);
+        return N;
+    }
+
+    ASTNode *visitLoop(LoopAST *N) {
+        fold(N->Cond);
+        Constant Cond = constantOf(N->Cond);
+        if (Cond.Ty.Kind == QType::Int && Cond.I == 0) return nullptr;
+        fold(N->Body);
+        return N;
+    }
+
+    ASTNode *visitReturn(ReturnAST *N) {
+        foldStored(N->Expr);
+        return N;
+    }
+
+    ASTNode *visitLoopOverString(LoopOverStringAST *N) {
+        fold(N->StringExpr);
+        Constant Str = constantOf(N->StringExpr);
+        if (Str.S && Str.S->empty()) return nullptr;
+        ScopedSymbolTable<ASTNode*>::Scope Scope(Known);
+        fold(N->Body);
+        return N;
+    }
+};
+
+} // namespace
+
+void foldConstants(FunctionAST *F, ASTArena &Arena) {
+    ConstantFolder(Arena).run(F);
+}
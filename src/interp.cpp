@@ -0,0 +1,842 @@
+#include "../include/quanta.h"
+#include "../include/quanta_compiler.h"
+#include "../include/quanta_runtime.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <optional>
+
+extern std::unique_ptr<llvm::LLVMContext> TheContext;
+extern std::unique_ptr<llvm::Module> TheModule;
+extern std::unique_ptr<llvm::IRBuilder<>> Builder;
+
+// --- TIERED EXECUTION (--tiered) ---
+// A short script spends far longer in the backend, the linker and process
+// startup than it does running. With --tiered the whole program is still
+// generated to IR first, so it is checked exactly as a native build would
+// check it, but then it runs in this process:
+//   Tier 0 walks the AST and counts, per function, calls and loop iterations.
+//   Tier 1 is the function's IR, compiled on its own (plus whatever it calls
+//   that is not compiled yet) into an LLJIT once its count reaches the
+//   threshold. Every later call goes to the native code.
+// There is no on-stack replacement: a hot loop stays in tier 0 until its
+// function is called again, so top-level script loops are always
+// interpreted (the functions they call are not). Fixed strings, arrays and
+// lists have no tier 0; functions using them are compiled before they first
+// run. Values follow the IR's types (integer widths, float vs double), so
+// both tiers compute the same results.
+//
+// The compiler also runs tier 0 on its own, to evaluate calls to 'const'
+// functions (evaluateConstCall()). Then nothing may print or be compiled,
+// and a call gets a fixed budget of calls and loop iterations.
+
+namespace {
+
+struct Value {
+    enum KindTy : uint8_t { Void, Int, Float, Ptr };
+    KindTy Kind = Void;
+    uint8_t Bits = 0; // Int: 1 to 64, Float: 32 or 64
+    union {
+        int64_t I = 0; // i1 is 0 or 1, narrower ints are kept sign-extended
+        double F;      // 32-bit floats are kept rounded to float
+        const char *S;
+    };
+};
+
+Value makeInt(int64_t V, unsigned Bits) {
+    Value R;
+    R.Kind = Value::Int;
+    R.Bits = Bits;
+    if (Bits == 1) V &= 1;
+    else if (Bits < 64) V = (int64_t)((uint64_t)V << (64 - Bits)) >> (64 - Bits);
+    R.I = V;
+    return R;
+}
+
+Value makeFloat(double V, unsigned Bits) {
+    Value R;
+    R.Kind = Value::Float;
+    R.Bits = Bits;
+    R.F = Bits == 32 ? (double)(float)V : V;
+    return R;
+}
+
+Value makePtr(const char *S) {
+    Value R;
+    R.Kind = Value::Ptr;
+    R.Bits = 64;
+    R.S = S;
+    return R;
+}
+
+// The value as a signed integer (i1 'true' is -1, as LLVM sign-extends it)
+int64_t signedValue(const Value &V) { return V.Bits == 1 ? -V.I : V.I; }
+
+uint64_t unsignedValue(const Value &V) {
+    return V.Bits >= 64 ? (uint64_t)V.I : (uint64_t)V.I & ((1ULL << V.Bits) - 1);
+}
+
+// What the IR does to V when the types differ: CreateIntCast, SIToFP,
+// FPToSI and FPCast. SignedInt picks the integer extension.
+Value castTo(const Value &V, Value::KindTy Kind, unsigned Bits, bool SignedInt = true) {
+    if (V.Kind == Value::Int && Kind == Value::Int)
+        return makeInt(SignedInt ? signedValue(V) : (int64_t)unsignedValue(V), Bits);
+    if (V.Kind == Value::Int && Kind == Value::Float) return makeFloat((double)signedValue(V), Bits);
+    if (V.Kind == Value::Float && Kind == Value::Int) return makeInt((int64_t)V.F, Bits);
+    if (V.Kind == Value::Float && Kind == Value::Float) return makeFloat(V.F, Bits);
+    return V;
+}
+
+Value castTo(const Value &V, llvm::Type *T, bool SignedInt = true) {
+    if (T->isIntegerTy()) return castTo(V, Value::Int, T->getIntegerBitWidth(), SignedInt);
+    if (T->isFloatingPointTy()) return castTo(V, Value::Float, T->isFloatTy() ? 32 : 64, SignedInt);
+    if (T->isVoidTy()) return Value();
+    return V;
+}
+
+Value zeroOf(llvm::Type *T) {
+    if (T->isIntegerTy()) return makeInt(0, T->getIntegerBitWidth());
+    if (T->isFloatingPointTy()) return makeFloat(0, T->isFloatTy() ? 32 : 64);
+    if (T->isPointerTy()) return makePtr(nullptr);
+    return Value();
+}
+
+// What the IR branches on: != 0 (ordered for floats)
+bool isTrue(const Value &V) {
+    switch (V.Kind) {
+    case Value::Int:   return V.I != 0;
+    case Value::Float: return V.F < 0 || V.F > 0;
+    case Value::Ptr:   return V.S != nullptr;
+    default:           return false;
+    }
+}
+
+// Names type() reports, as codegen records them
+const std::string TypeFloat = "float", TypeString = "string", TypeBool = "bool",
+                  TypeChar = "char", TypeInt = "int", TypeUnknown = "unknown";
+
+// Tier 0 handles every node except the fixed-size and heap containers
+class TierZeroCheck : public ASTVisitor<TierZeroCheck> {
+public:
+    bool Supported = true;
+    void visitFixedStringDecl(FixedStringDeclAST *) { Supported = false; }
+    void visitArrayExpr(ArrayExprAST *) { Supported = false; }
+    void visitFixedArrayDecl(FixedArrayDeclAST *) { Supported = false; }
+    void visitDynamicListDecl(DynamicListDeclAST *) { Supported = false; }
+    void visitIndexAssign(IndexAssignAST *) { Supported = false; }
+};
+
+// Native entry for a compiled function: arguments and result in 64-bit
+// slots (integers sign-extended, floats as double, strings as pointers)
+using Trampoline = void (*)(uint64_t *Args, uint64_t *Ret);
+
+struct FunctionState {
+    FunctionAST *AST = nullptr;
+    llvm::Function *IR = nullptr;  // The definition calls to this name reach
+    bool Interpretable = true;
+    bool TierUpFailed = false;     // Stay in tier 0
+    uint64_t Heat = 0;             // Calls plus loop iterations
+    Trampoline Native = nullptr;
+};
+
+struct Variable {
+    Value V;
+    const std::string *TypeName;
+};
+
+struct Frame {
+    FunctionState *Fn;
+    ScopedSymbolTable<Variable> Vars;
+    std::vector<char*> Heap; // Strings this call allocated, freed when it returns
+    bool Returned = false;
+    Value Result;
+
+    explicit Frame(FunctionState *Fn) : Fn(Fn) {}
+    ~Frame() {
+        for (char *P : Heap) free(P);
+    }
+    const char *own(char *P) {
+        Heap.push_back(P);
+        return P;
+    }
+};
+
+// Compile-time evaluation: calls plus loop iterations, and call depth
+const uint64_t ConstEvalSteps = 1000000;
+const unsigned ConstEvalDepth = 256;
+
+class TierZero : public ASTVisitor<TierZero, Value> {
+    unsigned TierUpAt;
+    std::unordered_map<SymbolID, FunctionState> Functions;
+    Frame *Cur = nullptr;
+    bool Trapped = false;
+    std::vector<char*> Escaped; // Strings main returned
+
+    // Compile-time evaluation: functions come from the registry as calls reach them
+    bool CompileTime = false;
+    uint64_t Steps = 0;
+    unsigned Depth = 0;
+
+    // Tier 1, created on the first tier-up
+    std::unique_ptr<llvm::orc::LLJIT> JIT;
+    std::optional<llvm::orc::ThreadSafeContext> Context; // Owns TheContext once set
+    llvm::SmallPtrSet<llvm::Function*, 32> InJIT;
+    std::vector<SymbolID> TieredUp; // In tier-up order, for the summary
+
+public:
+    TierZero(const ProgramAST &Program, unsigned TierUpAt) : TierUpAt(TierUpAt) {
+        for (FunctionAST *F : Program.functions) {
+            // A name defined twice: calls reach the first definition
+            auto [It, Fresh] = Functions.try_emplace(F->getName());
+            if (!Fresh) continue;
+            FunctionState &S = It->second;
+            S.AST = F;
+            S.IR = TheModule->getFunction(symbolName(F->getName()));
+            TierZeroCheck Check;
+            for (ASTNode *Stmt : F->Body) Check.visit(Stmt);
+            S.Interpretable = Check.Supported;
+        }
+    }
+
+    TierZero() : TierUpAt(0), CompileTime(true), Steps(ConstEvalSteps) {}
+
+    ~TierZero() {
+        for (char *P : Escaped) free(P);
+        // Compiled code first, then the IR, then the context that owns it
+        JIT.reset();
+        if (Context) {
+            Builder.reset();
+            TheModule.reset();
+        }
+    }
+
+    int run();
+    ASTNode *evaluate(CallAST *N, ASTArena &Arena);
+
+    // --- Values ---
+    Value visitNumber(NumberAST *N) { return makeInt(N->Val, N->Bits); }
+    Value visitFloat(FloatAST *N) { return makeFloat(N->Val, 64); }
+    Value visitBool(BoolAST *N) { return makeInt(N->Val, 1); }
+    Value visitChar(CharAST *N) { return makeInt(N->Val, 8); }
+    Value visitString(StringAST *N) { return makePtr(N->val.c_str()); }
+
+    // --- Variables ---
+    Value visitVariable(VariableAST *N);
+    Value visitVarDecl(VarDeclAST *N);
+    Value visitAssignment(AssignmentAST *N);
+    Value visitUpdateExpr(UpdateExprAST *N);
+    Value visitByteSize(ByteSizeAST *N);
+    Value visitTypeof(TypeofAST *N);
+
+    // --- Expressions ---
+    Value visitBinaryExpr(BinaryExprAST *N);
+    Value visitPrint(PrintAST *N);
+    Value visitStringIndex(StringIndexAST *N);
+    Value visitStringSlice(StringSliceAST *N);
+    Value visitMethodCall(MethodCallAST *N);
+    Value visitCall(CallAST *N);
+
+    // --- Control flow ---
+    Value visitBlock(BlockAST *N);
+    Value visitIfExpr(IfExprAST *N);
+    Value visitLoop(LoopAST *N);
+    Value visitLoopOverString(LoopOverStringAST *N);
+    Value visitReturn(ReturnAST *N);
+
+    // Containers never reach here (see TierZeroCheck)
+    Value visitNode(ASTNode *) { return trap("construct not supported by the interpreter"); }
+
+private:
+    bool stopped() const { return Trapped || Cur->Returned; }
+    Value trap(const std::string &Message) {
+        if (!Trapped && !CompileTime) diag() << "\n[Quanta Error] " << Message << std::endl;
+        Trapped = true;
+        return Value();
+    }
+    // Counts a call or an iteration against the compile-time budget
+    bool step() {
+        if (!CompileTime) return true;
+        if (Steps == 0) {
+            trap("Evaluation ran too long");
+            return false;
+        }
+        --Steps;
+        return true;
+    }
+
+    FunctionState *function(SymbolID Name);
+
+    Value call(FunctionState &S, std::vector<Value> &Args);
+    Value interpret(FunctionState &S, std::vector<Value> &Args);
+    Value callNative(FunctionState &S, std::vector<Value> &Args);
+    bool tierUp(FunctionState &S);
+};
+
+// --- 1. VARIABLES ---
+
+Value TierZero::visitVariable(VariableAST *N) {
+    Variable *Var = Cur->Vars.lookup(N->Name);
+    // A default argument reading the caller's variable has no value yet
+    if (!Var && CompileTime) return trap("Unknown variable: " + symbolName(N->Name));
+    // Declared on a path not taken: the IR would read an uninitialized slot
+    return Var ? Var->V : makeInt(0, 32);
+}
+
+Value TierZero::visitVarDecl(VarDeclAST *N) {
+    Value Init = visit(N->InitVal);
+    if (stopped()) return Value();
+
+    // Same storage type as VarDeclAST::codegen()
+    QType T = variableType(N->Type, N->Bytes);
+    Value::KindTy Kind = T.Kind == QType::Float ? Value::Float : T.Kind == QType::String ? Value::Ptr : Value::Int;
+    unsigned Bits = T.Kind == QType::String ? 64 : T.Bits;
+    // Booleans widen without sign extension
+    Value V = castTo(Init, Kind, Bits, !(Init.Kind == Value::Int && Init.Bits == 1));
+    Cur->Vars.declare(N->Name, {V, &N->Type});
+    return V;
+}
+
+Value TierZero::visitAssignment(AssignmentAST *N) {
+    Value V = visit(N->RHS);
+    if (stopped()) return Value();
+
+    Variable *Var = Cur->Vars.lookup(N->Name);
+    if (!Var) {
+        const std::string *TypeName = &TypeUnknown;
+        if (V.Kind == Value::Float && V.Bits == 64) TypeName = &TypeFloat;
+        else if (V.Kind == Value::Ptr) TypeName = &TypeString;
+        else if (V.Kind == Value::Int) TypeName = V.Bits == 1 ? &TypeBool : V.Bits == 8 ? &TypeChar : &TypeInt;
+        Cur->Vars.declare(N->Name, {V, TypeName});
+        return V;
+    }
+
+    // Existing variable: AssignmentAST::codegen() zero-extends integers
+    Value &Old = Var->V;
+    if (V.Kind == Value::Int && Old.Kind == Value::Int) V = castTo(V, Value::Int, Old.Bits, false);
+    else V = castTo(V, Old.Kind, Old.Bits);
+    Old = V;
+    return V;
+}
+
+Value TierZero::visitUpdateExpr(UpdateExprAST *N) {
+    Variable *Slot = Cur->Vars.lookup(N->Name);
+    if (!Slot) return makeInt(0, 32);
+    Value &Var = Slot->V;
+    Value Old = Var;
+    if (Old.Kind == Value::Float) Var = makeFloat(Old.F + (N->IsIncrement ? 1 : -1), Old.Bits);
+    else Var = makeInt((int64_t)((uint64_t)Old.I + (N->IsIncrement ? 1 : -1)), Old.Bits ? Old.Bits : 32);
+    return N->IsPrefix ? Var : Old;
+}
+
+Value TierZero::visitByteSize(ByteSizeAST *N) {
+    Variable *Var = Cur->Vars.lookup(N->Name);
+    if (!Var) return makeInt(0, 64);
+    const Value &V = Var->V;
+    return makeInt(V.Kind == Value::Ptr ? 8 : V.Bits / 8, 64);
+}
+
+Value TierZero::visitTypeof(TypeofAST *N) {
+    Variable *Var = Cur->Vars.lookup(N->Name);
+    return makePtr(Var ? Var->TypeName->c_str() : TypeUnknown.c_str());
+}
+
+// --- 2. EXPRESSIONS ---
+
+Value TierZero::visitBinaryExpr(BinaryExprAST *N) {
+    Value L = visit(N->LHS);
+    if (stopped()) return Value();
+    Value R = visit(N->RHS);
+    if (stopped()) return Value();
+
+    // A. Strings
+    if (L.Kind == Value::Ptr && R.Kind == Value::Ptr) {
+        if (N->Op == '+') {
+            size_t LenL = std::strlen(L.S), LenR = std::strlen(R.S);
+            char *Joined = static_cast<char*>(std::malloc(LenL + LenR + 1));
+            std::memcpy(Joined, L.S, LenL);
+            std::memcpy(Joined + LenL, R.S, LenR + 1);
+            return makePtr(Cur->own(Joined));
+        }
+        int Cmp = std::strcmp(L.S, R.S);
+        switch (N->Op) {
+        case TOK_EQ:  return makeInt(Cmp == 0, 32);
+        case TOK_NEQ: return makeInt(Cmp != 0, 32);
+        case '<':     return makeInt(Cmp < 0, 32);
+        case '>':     return makeInt(Cmp > 0, 32);
+        case TOK_LEQ: return makeInt(Cmp <= 0, 32);
+        case TOK_GEQ: return makeInt(Cmp >= 0, 32);
+        }
+        return trap("Invalid operator for strings");
+    }
+    if (L.Kind != R.Kind && (L.Kind == Value::Ptr || R.Kind == Value::Ptr))
+        return trap("Cannot mix strings and numbers in an expression");
+
+    // B. Floats: an integer operand converts to the other side's type
+    if (L.Kind == Value::Float || R.Kind == Value::Float) {
+        if (L.Kind != Value::Float) L = castTo(L, Value::Float, R.Bits);
+        if (R.Kind != Value::Float) R = castTo(R, Value::Float, L.Bits);
+        unsigned Bits = std::max(L.Bits, R.Bits);
+        double A = L.F, B = R.F;
+        switch (N->Op) {
+        case '+':     return makeFloat(A + B, Bits);
+        case '-':     return makeFloat(A - B, Bits);
+        case '*':     return makeFloat(A * B, Bits);
+        case '/':     return makeFloat(A / B, Bits);
+        case '%':     return makeFloat(std::fmod(A, B), Bits);
+        case '<':     return makeInt(A < B, 32);
+        case '>':     return makeInt(A > B, 32);
+        case TOK_LEQ: return makeInt(A <= B, 32);
+        case TOK_GEQ: return makeInt(A >= B, 32);
+        case TOK_EQ:  return makeInt(A == B, 32);
+        case TOK_NEQ: return makeInt(A < B || A > B, 32);
+        }
+        return trap("Invalid operator for numbers");
+    }
+
+    // C. Integers, in the wider of the two types
+    unsigned Bits = std::max(L.Bits, R.Bits);
+    int64_t A = signedValue(L), B = signedValue(R);
+    switch (N->Op) {
+    case '+': return makeInt((int64_t)((uint64_t)A + (uint64_t)B), Bits);
+    case '-': return makeInt((int64_t)((uint64_t)A - (uint64_t)B), Bits);
+    case '*': return makeInt((int64_t)((uint64_t)A * (uint64_t)B), Bits);
+    case '/':
+    case '%': {
+        // Where the native code would die of SIGFPE
+        int64_t Min = Bits >= 64 ? INT64_MIN : -(int64_t(1) << (Bits - 1));
+        if (B == 0 || (B == -1 && A == Min)) return trap("Integer division by zero or overflow");
+        return makeInt(N->Op == '/' ? A / B : A % B, Bits);
+    }
+    case '<':     return makeInt(A < B, 32);
+    case '>':     return makeInt(A > B, 32);
+    case TOK_LEQ: return makeInt(A <= B, 32);
+    case TOK_GEQ: return makeInt(A >= B, 32);
+    case TOK_EQ:  return makeInt(A == B, 32);
+    case TOK_NEQ: return makeInt(A != B, 32);
+    }
+    return trap("Invalid operator for numbers");
+}
+
+// Same printf formats as PrintAST::codegen(), one argument at a time
+Value TierZero::visitPrint(PrintAST *N) {
+    if (CompileTime) return trap("Cannot print while compiling");
+    for (size_t i = 0; i < N->Args.size(); ++i) {
+        Value V = visit(N->Args[i]);
+        if (stopped()) return Value();
+        switch (V.Kind) {
+        case Value::Int:
+            if (V.Bits == 8) std::printf("%c", (int)unsignedValue(V));
+            else if (V.Bits == 64) std::printf("%lld", (long long)V.I);
+            else std::printf("%d", (int)V.I);
+            break;
+        case Value::Float: std::printf("%f", V.F); break;
+        case Value::Ptr:   std::printf("%s", V.S); break;
+        default:           return trap("Cannot print a void return value.");
+        }
+        if (i < N->Args.size() - 1) std::printf(" ");
+    }
+    std::printf("\n");
+    std::fflush(nullptr);
+    return makeInt(0, 32);
+}
+
+Value TierZero::visitStringIndex(StringIndexAST *N) {
+    Value Base = visit(N->BaseExpr);
+    if (stopped()) return Value();
+    Value Index = visit(N->IndexExpr);
+    if (stopped()) return Value();
+    if (Base.Kind != Value::Ptr || !Base.S || Index.Kind != Value::Int)
+        return trap("Indexing needs a string and an integer");
+    int64_t Len = (int64_t)std::strlen(Base.S);
+    int64_t I = signedValue(Index);
+    if (I < 0) I += Len; // -1 is the last character
+    // Native code does not check the index (s[len] reads the terminator), so
+    // only a 'const' call gives up here and is left to run time
+    if (CompileTime && (I < 0 || I >= Len)) return trap("String index out of range");
+    return makeInt(Base.S[I], 8);
+}
+
+Value TierZero::visitStringSlice(StringSliceAST *N) {
+    Value Base = visit(N->BaseExpr);
+    if (stopped()) return Value();
+    Value Start = visit(N->StartExpr);
+    if (stopped()) return Value();
+    Value End = visit(N->EndExpr);
+    if (stopped()) return Value();
+    Value Step = makeInt(1, 32);
+    if (N->StepExpr) {
+        Step = visit(N->StepExpr);
+        if (stopped()) return Value();
+    }
+    if (Base.Kind != Value::Ptr || !Base.S) return trap("Slicing needs a string");
+    return makePtr(Cur->own(quanta_slice(Base.S, (int)signedValue(Start), (int)signedValue(End), (int)signedValue(Step))));
+}
+
+Value TierZero::visitMethodCall(MethodCallAST *N) {
+    Value Obj = visit(N->Obj);
+    if (stopped()) return Value();
+    std::vector<Value> Args;
+    for (ASTNode *Arg : N->Args) {
+        Args.push_back(visit(Arg));
+        if (stopped()) return Value();
+    }
+    if (Obj.Kind != Value::Ptr || !Obj.S) return trap("Unsupported method '" + symbolName(N->MethodName) + "' on object");
+    const char *S = Obj.S;
+
+    // A wrong argument list is reported by codegen, but 'const' calls get
+    // here first: never read arguments that are not there
+    size_t Arity = 0;
+    switch (N->MethodName) {
+    case SYM_FIND: case SYM_COUNT: case SYM_STARTSWITH: case SYM_ENDSWITH: Arity = 1; break;
+    case SYM_REPLACE: Arity = 2; break;
+    default: break;
+    }
+    if (Arity) {
+        bool Strings = Args.size() == Arity;
+        for (const Value &Arg : Args) Strings = Strings && Arg.Kind == Value::Ptr && Arg.S;
+        if (!Strings) return trap(symbolName(N->MethodName) + "() needs " + std::to_string(Arity) + " string argument(s)");
+    }
+
+    switch (N->MethodName) {
+    case SYM_LEN:        return makeInt((int64_t)std::strlen(S), 32);
+    case SYM_ISUPPER:    return makeInt(quanta_isupper(S), 32);
+    case SYM_ISLOWER:    return makeInt(quanta_islower(S), 32);
+    case SYM_ISALPHA:    return makeInt(quanta_isalpha(S), 32);
+    case SYM_ISDIGIT:    return makeInt(quanta_isdigit(S), 32);
+    case SYM_ISSPACE:    return makeInt(quanta_isspace(S), 32);
+    case SYM_ISALNUM:    return makeInt(quanta_isalnum(S), 32);
+    case SYM_UPPER:      return makePtr(Cur->own(quanta_upper(S)));
+    case SYM_LOWER:      return makePtr(Cur->own(quanta_lower(S)));
+    case SYM_REVERSE:    return makePtr(Cur->own(quanta_reverse(S)));
+    case SYM_STRIP:      return makePtr(Cur->own(quanta_strip(S)));
+    case SYM_LSTRIP:     return makePtr(Cur->own(quanta_lstrip(S)));
+    case SYM_RSTRIP:     return makePtr(Cur->own(quanta_rstrip(S)));
+    case SYM_CAPITALIZE: return makePtr(Cur->own(quanta_capitalize(S)));
+    case SYM_TITLE:      return makePtr(Cur->own(quanta_title(S)));
+    case SYM_FIND:       return makeInt(quanta_find(S, Args[0].S), 32);
+    case SYM_COUNT:      return makeInt(quanta_count(S, Args[0].S), 32);
+    case SYM_STARTSWITH: return makeInt(quanta_startswith(S, Args[0].S), 32);
+    case SYM_ENDSWITH:   return makeInt(quanta_endswith(S, Args[0].S), 32);
+    case SYM_REPLACE:    return makePtr(Cur->own(quanta_replace(S, Args[0].S, Args[1].S)));
+    default:             return trap("Unsupported method '" + symbolName(N->MethodName) + "' on object");
+    }
+}
+
+// Arguments are matched to parameters exactly as CallAST::codegen() does:
+// keywords, then positions, then defaults (evaluated in the caller)
+Value TierZero::visitCall(CallAST *N) {
+    FunctionState *Callee = function(N->Callee);
+    if (!Callee || !Callee->IR) return trap("Undefined function: " + symbolName(N->Callee));
+    FunctionState &S = *Callee;
+    auto RegIt = FunctionRegistry.find(N->Callee);
+    const FunctionInfo *FuncInfo = RegIt != FunctionRegistry.end() ? &RegIt->second : nullptr;
+
+    size_t Expected = S.IR->arg_size();
+    std::vector<Value> Args(Expected);
+    std::vector<bool> Given(Expected, false);
+    size_t PositionalSlot = 0;
+    for (const CallArg &Arg : N->Args) {
+        Value V = visit(Arg.Val);
+        if (stopped()) return Value();
+        size_t Slot = PositionalSlot;
+        if (Arg.Name != SYM_NONE) {
+            for (Slot = 0; FuncInfo && Slot < FuncInfo->Args.size() && FuncInfo->Args[Slot].Name != Arg.Name; ++Slot) {}
+        } else {
+            while (Slot < Expected && Given[Slot]) Slot++;
+            PositionalSlot = Slot + 1;
+        }
+        if (Slot >= Expected || Given[Slot]) return trap("Bad arguments in call to " + symbolName(N->Callee));
+        Args[Slot] = V;
+        Given[Slot] = true;
+    }
+    for (size_t i = 0; i < Expected; ++i) {
+        if (!Given[i]) {
+            if (!FuncInfo || i >= FuncInfo->Args.size() || !FuncInfo->Args[i].DefaultValue)
+                return trap("Missing required argument #" + std::to_string(i + 1));
+            Args[i] = visit(FuncInfo->Args[i].DefaultValue);
+            if (stopped()) return Value();
+        }
+        Args[i] = castTo(Args[i], S.IR->getArg(i)->getType());
+    }
+    return call(S, Args);
+}
+
+// --- 3. CONTROL FLOW ---
+
+Value TierZero::visitBlock(BlockAST *N) {
+    Value Last = makeFloat(0, 64);
+    ScopedSymbolTable<Variable>::Scope Scope(Cur->Vars);
+    for (ASTNode *Stmt : N->Statements) {
+        Last = visit(Stmt);
+        if (stopped()) break;
+    }
+    return Last;
+}
+
+Value TierZero::visitIfExpr(IfExprAST *N) {
+    Value Cond = visit(N->Cond);
+    if (stopped()) return Value();
+    if (isTrue(Cond)) visit(N->Then);
+    else if (N->Else) visit(N->Else);
+    return makeFloat(0, 64);
+}
+
+Value TierZero::visitLoop(LoopAST *N) {
+    while (true) {
+        Value Cond = visit(N->Cond);
+        if (stopped() || !isTrue(Cond)) break;
+        visit(N->Body);
+        if (stopped() || !step()) break;
+        Cur->Fn->Heat++;
+    }
+    return makeFloat(0, 64);
+}
+
+Value TierZero::visitLoopOverString(LoopOverStringAST *N) {
+    Value Str = visit(N->StringExpr);
+    if (stopped()) return Value();
+    if (Str.Kind != Value::Ptr || !Str.S) return trap("Looping needs a string");
+    int32_t Len = (int32_t)std::strlen(Str.S);
+    // The body may assign the index, but the next one counts on from the old
+    for (int32_t I = 0; I < Len; I++) {
+        ScopedSymbolTable<Variable>::Scope Scope(Cur->Vars);
+        Cur->Vars.declare(N->VarName, {makeInt(I, 32), &TypeInt});
+        visit(N->Body);
+        if (stopped() || !step()) break;
+        Cur->Fn->Heat++;
+    }
+    return makeFloat(0, 64);
+}
+
+Value TierZero::visitReturn(ReturnAST *N) {
+    Value V = visit(N->Expr);
+    if (stopped()) return Value();
+    Cur->Result = castTo(V, Cur->Fn->IR->getReturnType());
+    Cur->Returned = true;
+    return Cur->Result;
+}
+
+// --- 4. CALLS AND TIER-UP ---
+
+FunctionState *TierZero::function(SymbolID Name) {
+    auto It = Functions.find(Name);
+    if (It != Functions.end()) return &It->second;
+    if (!CompileTime) return nullptr;
+
+    // The definition calls reach, declared in the module if it is not generated yet
+    auto RegIt = FunctionRegistry.find(Name);
+    if (RegIt == FunctionRegistry.end() || !RegIt->second.Decl) return nullptr;
+    FunctionAST *F = RegIt->second.Decl;
+    FunctionState &S = Functions[Name];
+    S.AST = F;
+    S.IR = TheModule->getFunction(symbolName(Name));
+    if (!S.IR) S.IR = F->codegenPrototype();
+    // --stream parses a body only when it is generated, and drops it after
+    TierZeroCheck Check;
+    for (ASTNode *Stmt : F->Body) Check.visit(Stmt);
+    S.Interpretable = Check.Supported && !F->Body.empty() && S.IR->arg_size() == F->Args.size();
+    return &S;
+}
+
+Value TierZero::call(FunctionState &S, std::vector<Value> &Args) {
+    if (CompileTime) {
+        if (!S.Interpretable || Depth == ConstEvalDepth || !step())
+            return trap("Cannot evaluate " + symbolName(S.AST->getName()));
+        ++Depth;
+        Value Result = interpret(S, Args);
+        --Depth;
+        return Result;
+    }
+    if (!S.Native && !S.TierUpFailed && (!S.Interpretable || ++S.Heat >= TierUpAt)) {
+        if (!tierUp(S)) S.TierUpFailed = true;
+    }
+    if (S.Native) return callNative(S, Args);
+    if (!S.Interpretable) return trap("Could not compile " + symbolName(S.AST->getName()));
+    return interpret(S, Args);
+}
+
+Value TierZero::interpret(FunctionState &S, std::vector<Value> &Args) {
+    Frame F(&S);
+    for (size_t i = 0; i < Args.size(); ++i) F.Vars.declare(S.AST->Args[i].Name, {Args[i], &S.AST->Args[i].Type});
+
+    Frame *Caller = Cur;
+    Cur = &F;
+    for (ASTNode *Stmt : S.AST->Body) {
+        visit(Stmt);
+        if (stopped()) break;
+    }
+    Cur = Caller;
+
+    // Falling off the end returns zero; a returned string outlives the call
+    Value Result = F.Returned ? F.Result : zeroOf(S.IR->getReturnType());
+    if (Result.Kind == Value::Ptr) {
+        auto It = std::find(F.Heap.begin(), F.Heap.end(), Result.S);
+        if (It != F.Heap.end()) {
+            (Caller ? Caller->Heap : Escaped).push_back(*It);
+            F.Heap.erase(It);
+        }
+    }
+    return Result;
+}
+
+Value TierZero::callNative(FunctionState &S, std::vector<Value> &Args) {
+    std::vector<uint64_t> Slots(Args.size());
+    for (size_t i = 0; i < Args.size(); ++i) {
+        if (Args[i].Kind == Value::Float) std::memcpy(&Slots[i], &Args[i].F, sizeof(double));
+        else if (Args[i].Kind == Value::Ptr) Slots[i] = (uint64_t)(uintptr_t)Args[i].S;
+        else Slots[i] = (uint64_t)Args[i].I;
+    }
+    uint64_t Ret = 0;
+    S.Native(Slots.data(), &Ret);
+
+    llvm::Type *RetTy = S.IR->getReturnType();
+    if (RetTy->isIntegerTy()) return makeInt((int64_t)Ret, RetTy->getIntegerBitWidth());
+    if (RetTy->isFloatingPointTy()) {
+        double D;
+        std::memcpy(&D, &Ret, sizeof(double));
+        return makeFloat(D, RetTy->isFloatTy() ? 32 : 64);
+    }
+    if (RetTy->isPointerTy()) return makePtr((const char*)(uintptr_t)Ret);
+    return Value();
+}
+
+// void quanta.tier.F(i64 *Args, i64 *Ret): unpacks the slots and calls F
+static llvm::Function *emitTrampoline(llvm::Function *F, llvm::Module &M) {
+    llvm::IRBuilder<> B(M.getContext());
+    llvm::Type *SlotTy = B.getInt64Ty();
+    llvm::FunctionType *FT = llvm::FunctionType::get(B.getVoidTy(), {B.getPtrTy(), B.getPtrTy()}, false);
+    llvm::Function *T = llvm::Function::Create(FT, llvm::Function::ExternalLinkage, "quanta.tier." + F->getName(), &M);
+    B.SetInsertPoint(llvm::BasicBlock::Create(M.getContext(), "entry", T));
+
+    std::vector<llvm::Value*> CallArgs;
+    for (llvm::Argument &A : F->args()) {
+        llvm::Value *Slot = B.CreateConstGEP1_32(SlotTy, T->getArg(0), A.getArgNo());
+        llvm::Type *Ty = A.getType();
+        if (Ty->isIntegerTy()) CallArgs.push_back(B.CreateTrunc(B.CreateLoad(SlotTy, Slot), Ty));
+        else if (Ty->isFloatingPointTy()) CallArgs.push_back(B.CreateFPCast(B.CreateLoad(B.getDoubleTy(), Slot), Ty));
+        else CallArgs.push_back(B.CreateLoad(Ty, Slot));
+    }
+    llvm::Value *R = B.CreateCall(F, CallArgs);
+
+    llvm::Type *RetTy = F->getReturnType();
+    if (RetTy->isIntegerTy()) R = B.CreateIntCast(R, SlotTy, RetTy->getIntegerBitWidth() > 1);
+    else if (RetTy->isFloatingPointTy()) R = B.CreateFPCast(R, B.getDoubleTy());
+    if (!RetTy->isVoidTy()) B.CreateStore(R, T->getArg(1));
+    B.CreateRetVoid();
+    return T;
+}
+
+// Compiles S, and every function it reaches that is not compiled yet, from
+// a copy of their IR. Functions compiled earlier are only declared there.
+bool TierZero::tierUp(FunctionState &S) {
+    if (!JIT) {
+        auto Created = quanta::createJIT();
+        if (!Created) {
+            diag() << "[Codegen Error] " << llvm::toString(Created.takeError()) << std::endl;
+            return false;
+        }
+        JIT = std::move(*Created);
+        // The IR stays in its context; every tier-up module is a copy in it
+        TheModule->setDataLayout(JIT->getDataLayout());
+        Context.emplace(std::move(TheContext));
+    }
+
+    llvm::SmallPtrSet<const llvm::GlobalValue*, 16> Defs;
+    std::vector<llvm::Function*> Work;
+    if (!InJIT.count(S.IR)) {
+        Defs.insert(S.IR);
+        Work.push_back(S.IR);
+    }
+    while (!Work.empty()) {
+        llvm::Function *F = Work.back();
+        Work.pop_back();
+        for (llvm::Instruction &I : llvm::instructions(*F)) {
+            auto *Call = llvm::dyn_cast<llvm::CallInst>(&I);
+            llvm::Function *Callee = Call ? Call->getCalledFunction() : nullptr;
+            if (Callee && !Callee->isDeclaration() && !InJIT.count(Callee) && Defs.insert(Callee).second)
+                Work.push_back(Callee);
+        }
+    }
+
+    llvm::ValueToValueMapTy VMap;
+    std::unique_ptr<llvm::Module> M = llvm::CloneModule(*TheModule, VMap, [&](const llvm::GlobalValue *GV) {
+        return !llvm::isa<llvm::Function>(GV) || Defs.count(GV);
+    });
+    llvm::Function *T = emitTrampoline(llvm::cast<llvm::Function>(VMap[S.IR]), *M);
+    std::string Name = T->getName().str();
+
+    llvm::Error Err = JIT->addIRModule(llvm::orc::ThreadSafeModule(std::move(M), *Context));
+    if (!Err) {
+        auto Addr = JIT->lookup(Name);
+        if (Addr) S.Native = reinterpret_cast<Trampoline>(Addr->toPtr<void*>());
+        else Err = Addr.takeError();
+    }
+    if (Err) {
+        diag() << "[Codegen Error] " << llvm::toString(std::move(Err)) << std::endl;
+        return false;
+    }
+    for (const llvm::GlobalValue *GV : Defs) InJIT.insert(const_cast<llvm::Function*>(llvm::cast<llvm::Function>(GV)));
+    TieredUp.push_back(S.AST->getName());
+    return true;
+}
+
+int TierZero::run() {
+    auto It = Functions.find(SYM_MAIN);
+    if (It == Functions.end() || !It->second.IR) {
+        diag() << "Error: No 'main' function found!" << std::endl;
+        return -1;
+    }
+    std::vector<Value> NoArgs;
+    Value Result = call(It->second, NoArgs);
+    std::fflush(nullptr);
+    if (!TieredUp.empty()) {
+        info() << "[Tier] Compiled to native code:";
+        for (SymbolID Name : TieredUp) info() << " " << symbolName(Name);
+        info() << std::endl;
+    }
+    if (Trapped) return -1;
+    // Only the low byte of a process exit status survives
+    return Result.Kind == Value::Int ? (int)(Result.I & 0xff) : 0;
+}
+
+// The literal for what a call comes to, or null. The call runs from a
+// frame of its own: the caller's variables are not known here.
+ASTNode *TierZero::evaluate(CallAST *N, ASTArena &Arena) {
+    FunctionState Caller;
+    Frame Outer(&Caller);
+    Cur = &Outer;
+    Value V = visit(N);
+    Cur = nullptr;
+    if (Trapped) return nullptr;
+    switch (V.Kind) {
+    case Value::Int:
+        if (V.Bits == 1) return Arena.make<BoolAST>(V.I != 0);
+        return Arena.make<NumberAST>(V.I, V.Bits);
+    case Value::Float: return V.Bits == 64 ? Arena.make<FloatAST>(V.F) : nullptr; // No float literal
+    case Value::Ptr:   return V.S ? Arena.make<StringAST>(V.S) : nullptr;
+    default:           return nullptr;
+    }
+}
+
+} // namespace
+
+ASTNode *evaluateConstCall(CallAST *Call, ASTArena &Arena) {
+    return TierZero().evaluate(Call, Arena);
+}
+
+int runTiered(const ProgramAST &Program, unsigned TierUpAt) {
+    if (!initializeBackend()) return -1;
+    TierZero Interpreter(Program, TierUpAt);
+    return Interpreter.run();
+}
@@ -3,10 +3,213 @@
 #include <iostream>
 
 #include <cmath>
-std::vector<Token> tokenize(std::string source) {
-    std::vector<Token> tokens;
-    int i = 0;
-    int line = 1; // Start counting lines at 1
+#include <cstring>
+#include <algorithm>
+
+// --- BULK SCANNERS ---
+// Comment bodies, string literals and whitespace runs are scanned 16 bytes
+// at a time with SSE2 (32 with AVX2 when the compiler targets it), counting
+// newlines for line tracking in the same pass. Other targets use memchr and
+// std::count, which libc and the optimizer vectorize on their own.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define QUANTA_LEX_SSE2 1
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define QUANTA_LEX_AVX2 1
+#endif
+
+std::ostream &Lexer::report() {
+    static thread_local std::ostream Discard(nullptr);
+    return Quiet ? Discard : diag();
+}
+
+// Same set as isspace() in the C locale
+static inline bool isBlank(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Returns the index of the first 'target' in s[i, end) (or end) and adds the
+// number of newlines skipped over to 'line'.
+static size_t scanUntil(const char *s, size_t i, size_t end, char target, int &line) {
+#if QUANTA_LEX_AVX2
+    const __m256i want32 = _mm256_set1_epi8(target);
+    const __m256i nl32 = _mm256_set1_epi8('\n');
+    while (i + 32 <= end) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i *)(s + i));
+        uint32_t hit = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, want32));
+        uint32_t nl = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, nl32));
+        if (hit) {
+            unsigned k = __builtin_ctz(hit);
+            line += __builtin_popcount(nl & ((1u << k) - 1));
+            return i + k;
+        }
+        line += __builtin_popcount(nl);
+        i += 32;
+    }
+#endif
+#if QUANTA_LEX_SSE2
+    const __m128i want = _mm_set1_epi8(target);
+    const __m128i nl16 = _mm_set1_epi8('\n');
+    while (i + 16 <= end) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(s + i));
+        unsigned hit = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, want));
+        unsigned nl = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl16));
+        if (hit) {
+            unsigned k = __builtin_ctz(hit);
+            line += __builtin_popcount(nl & ((1u << k) - 1));
+            return i + k;
+        }
+        line += __builtin_popcount(nl);
+        i += 16;
+    }
+#endif
+    const char *found = (i < end) ? (const char *)std::memchr(s + i, target, end - i) : nullptr;
+    size_t stop = found ? (size_t)(found - s) : end;
+    if (stop > i) line += (int)std::count(s + i, s + stop, '\n');
+    return stop;
+}
+
+// Returns the index of the first non-blank byte in s[i, end) (or end),
+// adding the newlines in the run to 'line'.
+static size_t skipBlanks(const char *s, size_t i, size_t end, int &line) {
+#if QUANTA_LEX_SSE2
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i belowTab = _mm_set1_epi8('\t' - 1);
+    const __m128i aboveCr = _mm_set1_epi8('\r' + 1);
+    const __m128i nl16 = _mm_set1_epi8('\n');
+    while (i + 16 <= end) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(s + i));
+        // Signed compares: bytes >= 0x80 are negative and never blank
+        __m128i ctrl = _mm_and_si128(_mm_cmpgt_epi8(chunk, belowTab), _mm_cmplt_epi8(chunk, aboveCr));
+        unsigned blank = (unsigned)_mm_movemask_epi8(_mm_or_si128(ctrl, _mm_cmpeq_epi8(chunk, space)));
+        unsigned nl = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, nl16));
+        unsigned other = ~blank & 0xFFFFu;
+        if (other) {
+            unsigned k = __builtin_ctz(other);
+            line += __builtin_popcount(nl & ((1u << k) - 1));
+            return i + k;
+        }
+        line += __builtin_popcount(nl);
+        i += 16;
+    }
+#endif
+    while (i < end && isBlank(s[i])) {
+        if (s[i] == '\n') line++;
+        i++;
+    }
+    return i;
+}
+
+// True if id[from..] is empty or all digits ("int" / "int16", "float" / "float8")
+static bool allDigitsFrom(std::string_view id, size_t from) {
+    for (size_t k = from; k < id.length(); k++) {
+        if (!isdigit((unsigned char)id[k])) return false;
+    }
+    return true;
+}
+
+// --- RESERVED WORDS ---
+// Dispatch on (length, first char) so an identifier costs at most a few
+// fixed-length memcmp's instead of a walk down every keyword.
+static int classifyIdentifier(std::string_view id) {
+    auto is = [&](const char *kw) { return std::memcmp(id.data(), kw, id.length()) == 0; };
+
+    switch (id.length()) {
+        case 2:
+            if (id[0] == 'i') {
+                if (id[1] == 'f') return TOK_IF;
+                if (id[1] == 'n') return TOK_IN;
+            }
+            break;
+        case 3:
+            switch (id[0]) {
+                case 'a': if (is("all")) return TOK_ALL; break;
+                case 'v': if (is("var")) return TOK_VAR; break;
+                case 'l': if (is("len")) return TOK_LEN; break;
+            }
+            break;
+        case 4:
+            switch (id[0]) {
+                case 't': if (is("true")) return TOK_TRUE; break;
+                case 'b': if (is("bool")) return TOK_BOOL; break;
+                case 'c': if (is("char")) return TOK_CHAR; break;
+                case 'e':
+                    if (is("elif")) return TOK_ELIF;
+                    if (is("else")) return TOK_ELSE;
+                    break;
+                case 'l': if (is("loop")) return TOK_LOOP; break;
+                case 'v': if (is("void")) return TOK_VOID; break;
+                case 'f': if (is("find")) return TOK_FIND; break;
+            }
+            break;
+        case 5:
+            switch (id[0]) {
+                case 'p': if (is("print")) return TOK_PRINT; break;
+                case 'f': if (is("false")) return TOK_FALSE; break;
+                case 'u': if (is("upper")) return TOK_UPPER; break;
+                case 'l': if (is("lower")) return TOK_LOWER; break;
+                case 's': if (is("strip")) return TOK_STRIP; break;
+                case 't': if (is("title")) return TOK_TITLE; break;
+                case 'c':
+                    if (is("count")) return TOK_COUNT;
+                    if (is("const")) return TOK_CONST;
+                    break;
+            }
+            break;
+        case 6:
+            switch (id[0]) {
+                case 's': if (is("string")) return TOK_STRING; break;
+                case 'r':
+                    if (is("return")) return TOK_RETURN;
+                    if (is("rstrip")) return TOK_RSTRIP;
+                    break;
+                case 'i': if (is("import")) return TOK_IMPORT; break;
+                case 'l': if (is("lstrip")) return TOK_LSTRIP; break;
+            }
+            break;
+        case 7:
+            if (id[0] == 'r') {
+                if (is("reverse")) return TOK_REVERSE;
+                if (is("replace")) return TOK_REPLACE;
+            } else if (id[0] == 'i' && id[1] == 's') {
+                switch (id[2]) {
+                    case 'u': if (is("isupper")) return TOK_ISUPPER; break;
+                    case 'l': if (is("islower")) return TOK_ISLOWER; break;
+                    case 'd': if (is("isdigit")) return TOK_ISDIGIT; break;
+                    case 's': if (is("isspace")) return TOK_ISSPACE; break;
+                    case 'a':
+                        if (is("isalpha")) return TOK_ISALPHA;
+                        if (is("isalnum")) return TOK_ISALNUM;
+                        break;
+                }
+            }
+            break;
+        case 8:
+            if (is("endswith")) return TOK_ENDSWITH;
+            break;
+        case 10:
+            if (is("capitalize")) return TOK_CAPITALIZE;
+            if (is("startswith")) return TOK_STARTSWITH;
+            break;
+    }
+
+    // --- DETECT "int"/"intN" and "float"/"floatN" without building substrings ---
+    if (id.length() >= 3 && id[0] == 'i' && std::memcmp(id.data(), "int", 3) == 0) {
+        return allDigitsFrom(id, 3) ? TOK_INT : TOK_IDENTIFIER;
+    }
+    if (id.length() >= 5 && id[0] == 'f' && std::memcmp(id.data(), "float", 5) == 0) {
+        return allDigitsFrom(id, 5) ? TOK_FLOAT : TOK_IDENTIFIER;
+    }
+    return TOK_IDENTIFIER;
+}
+
+// Produces the next token, or TOK_EOF (repeatedly) once the source is used up.
+Token Lexer::next() {
+    std::string_view source = Source;
+    size_t &i = Pos;
+    int &line = Line;
 
     while (i < source.length()) {
         char c = source[i];
@@ -20,13 +223,16 @@ std::vector<Token> tokenize(std::string source) {
                 char quoteType = c; 
                 i += 3; // Skip the opening quotes
 
-                // Loop until we find the CLOSING quotes
-                while (i + 2 < source.length()) {
-                    if (source[i] == quoteType && source[i+1] == quoteType && source[i+2] == quoteType) {
+                // Jump from quote to quote until we find the CLOSING triple.
+                // (The last two bytes are never part of the body, as before.)
+                size_t bodyEnd = source.length() - 2;
+                while (i < bodyEnd) {
+                    i = scanUntil(source.data(), i, bodyEnd, quoteType, line);
+                    if (i >= bodyEnd) break;
+                    if (source[i+1] == quoteType && source[i+2] == quoteType) {
                         i += 3; // Skip the closing quotes
                         break;  
                     }
-                    if (source[i] == '\n') line++;
                     i++;
                 }
                 continue; 
@@ -35,41 +241,32 @@ std::vector<Token> tokenize(std::string source) {
 
         // --- 2. SINGLE LINE COMMENT (@) ---
         if (c == '@') {
-            while (i < source.length() && source[i] != '\n') {
-                i++;
-            }
+            int ignored = 0;
+            i = scanUntil(source.data(), i, source.length(), '\n', ignored);
             continue;
         }
 
-        // --- 3. WHITESPACE ---
-        if (c == '\n') {
-            line++;
-            i++;
-            continue;
-        }
-        if (isspace(c)) {
-            i++;
+        // --- 3. WHITESPACE (whole run at once, newlines counted in bulk) ---
+        if (isBlank(c)) {
+            i = skipBlanks(source.data(), i, source.length(), line);
             continue;
         }
         if (c == '+' && i + 1 < source.length() && source[i + 1] == '+') {
-            tokens.push_back({TOK_INC, "++", line});
             i += 2; // Skip both '+'
-            continue;
+            return {TOK_INC, line, "++"};
         }
 
         // 2. Handle --
         if (c == '-' && i + 1 < source.length() && source[i + 1] == '-') {
-            tokens.push_back({TOK_DEC, "--", line});
             i += 2; // Skip both '-'
-            continue;
+            return {TOK_DEC, line, "--"};
         }
         if (c == '.') {
-        tokens.push_back({TOK_DOT, ".", line}); // <--- NEW
         i++;
-        continue;
+        return {TOK_DOT, line, "."}; // <--- NEW
     }
     // if (c == '*') {
-    //     tokens.push_back({TOK_STAR, "*", line}); // <--- NEW (or use char '*')
+    //     tokens.push_back({TOK_STAR, line, "*"}); // <--- NEW (or use char '*')
     //     i++;
     //     continue;
     // }
@@ -81,116 +278,56 @@ std::vector<Token> tokenize(std::string source) {
             
             // 1. SAFETY: Check if file ended abruptly (e.g. just "'")
             if (i >= source.length()) {
-                std::cerr << "[Quanta Error] Line " << line << ": Empty char literal at end of file." << std::endl;
+                report() << "[Quanta Error] Line " << line << ": Empty char literal at end of file." << std::endl;
                 continue; 
             }
 
-            char charVal = source[i++]; // Read the character safely
+            std::string_view charVal = source.substr(i++, 1); // Read the character safely
             
             // 2. CHECK: Is the next char a closing quote?
             if (i < source.length() && source[i] == '\'') {
                 i++; // Eat end quote (Normal Case)
             } else {
                 // ERROR: We expected "'" but found something else (like 'aa')
-                std::cerr << "[Quanta Error] Line " << line << ": Missing closing quote for character literal. "  << std::endl;
+                report() << "[Quanta Error] Line " << line << ": Missing closing quote for character literal. "  << std::endl;
                 // We do NOT exit. We just don't eat the next char, letting the loop handle it next.
                 
             }
          
 
-            tokens.push_back({TOK_CHAR, std::string(1, charVal), line});
-            continue;
+            return {TOK_CHAR, line, charVal};
         }
 
         
         // --- 5. STRING LITERALS ---
         if (c == '"') {
-            std::string strVal;
             i++; 
-            while (i < source.length() && source[i] != '"') {
-                if (source[i] == '\n') line++;
-                strVal += source[i++];
-            }
+            size_t start = i;
+            i = scanUntil(source.data(), i, source.length(), '"', line);
+            std::string_view strVal = source.substr(start, i - start);
             if (i < source.length()) i++;
-            tokens.push_back({TOK_STRING, strVal, line}); 
-            continue;
+            return {TOK_STRING, line, strVal};
         }
 
         // --- 6. IDENTIFIERS & KEYWORDS ---
         // UPDATED: Allow starting with Underscore (_) or Letter
         if (isalpha(c) || c == '_') {
-            std::string idStr;
+            size_t start = i;
             
             // UPDATED: Allow Underscores (_) inside the name
             while (i < source.length() && (isalnum(source[i]) || source[i] == '_')) {
-                idStr += source[i++];
+                i++;
             }
+            std::string_view idStr = source.substr(start, i - start);
             
-            int type = TOK_IDENTIFIER; // Default to variable name
-            
-            // --- CHECK FOR RESERVED WORDS ---
-            if (idStr == "print") type = TOK_PRINT;
-            else if (idStr == "true") type = TOK_TRUE;
-            else if (idStr == "false") type = TOK_FALSE;
-            else if (idStr == "bool") type = TOK_BOOL;
-            else if (idStr == "char") type = TOK_CHAR;
-            else if (idStr == "all") type = TOK_ALL;
-            else if (idStr == "string") type = TOK_STRING;
-            else if (idStr == "var") type = TOK_VAR;
-                   else if (idStr == "if") type = TOK_IF;
-            else if (idStr == "elif") type = TOK_ELIF; 
-            else if (idStr == "else") type = TOK_ELSE;
-            else if (idStr == "loop") type= TOK_LOOP;
-            else if (idStr == "return") type = TOK_RETURN;
-            else if (idStr == "void") type = TOK_VOID;
-            else if (idStr == "import") type = TOK_IMPORT;
-            else if (idStr == "len") type = TOK_LEN;
-            else if (idStr == "upper") type = TOK_UPPER;
-            else if (idStr == "lower") type = TOK_LOWER;
-            else if (idStr == "reverse") type = TOK_REVERSE;
-            else if (idStr == "isupper") type = TOK_ISUPPER;
-            else if (idStr == "islower") type = TOK_ISLOWER;
-            else if (idStr == "strip") type = TOK_STRIP;
-            else if (idStr == "lstrip") type = TOK_LSTRIP;
-            else if (idStr == "rstrip") type = TOK_RSTRIP;
-            else if (idStr == "capitalize") type = TOK_CAPITALIZE;
-            else if (idStr == "title") type = TOK_TITLE;
-            else if (idStr == "isalpha") type = TOK_ISALPHA;
-            else if (idStr == "isdigit") type = TOK_ISDIGIT;
-            else if (idStr == "isspace") type = TOK_ISSPACE;
-            else if (idStr == "isalnum") type = TOK_ISALNUM;
-            else if (idStr == "find") type = TOK_FIND;
-            else if (idStr == "count") type = TOK_COUNT;
-            else if (idStr == "startswith") type = TOK_STARTSWITH;
-            else if (idStr == "endswith") type = TOK_ENDSWITH;
-            else if (idStr == "replace") type = TOK_REPLACE;
-            else if (idStr == "in") type = TOK_IN;
-            
-            
-            // --- DETECT "int" and "intN" ---
-            else if (idStr.substr(0, 3) == "int") {
-                bool isType = true;
-                for (size_t k = 3; k < idStr.length(); k++) {
-                    if (!isdigit(idStr[k])) { isType = false; break; }
-                }
-                if (isType) type = TOK_INT;
-            }
-            // --- DETECT "float" and "floatN" ---
-            else if (idStr.substr(0, 5) == "float") {
-                 bool isType = true;
-                 for (size_t k = 5; k < idStr.length(); k++) {
-                    if (!isdigit(idStr[k])) { isType = false; break; }
-                }
-                if (isType) type = TOK_FLOAT;
-            }
+            int type = classifyIdentifier(idStr);
 
-            tokens.push_back({type, idStr, line}); 
-            continue;
+            return {type, line, idStr};
         }
 
         // --- 7. NUMBERS ---
         if (isdigit(c)) {
-            std::string numStr;
+            size_t start = i;
             bool hasDecimal = false;
 
             while (i < source.length() && (isdigit(source[i]) || source[i] == '.')) {
@@ -198,23 +335,22 @@ std::vector<Token> tokenize(std::string source) {
                     if (hasDecimal) break;
                     hasDecimal = true;
                 }
-                numStr += source[i];
                 i++;
             }
+            std::string_view numStr = source.substr(start, i - start);
 
             // --- ERROR CHECK: Variable starting with digit ---
             // If we finished reading numbers but immediately see a letter or _, it's invalid.
             if (i < source.length() && (isalpha(source[i]) || source[i] == '_')) {
-                std::cerr << "\n[Quanta Error] Syntax Error at line " << line << std::endl;
-                std::cerr << "  Variable names cannot start with a digit." << std::endl;
+                report() << "\n[Quanta Error] Syntax Error at line " << line << std::endl;
+                report() << "  Variable names cannot start with a digit." << std::endl;
                 
                 // Read the rest of the bad identifier so we don't try to parse it next
-                std::string badName = numStr;
                 while (i < source.length() && (isalnum(source[i]) || source[i] == '_')) {
-                    badName += source[i];
                     i++;
                 }
-                std::cerr << "  -> Invalid identifier: '" << badName << "'\n" << std::endl;
+                std::string_view badName = source.substr(start, i - start);
+                report() << "  -> Invalid identifier: '" << badName << "'\n" << std::endl;
                 
                 // Skip generating a token for this error
                 continue; 
@@ -225,17 +361,17 @@ std::vector<Token> tokenize(std::string source) {
             if (hasDecimal) {
                 // --- FLOAT 64-BIT CHECK ---
                 errno = 0; 
-                double val = std::strtod(numStr.c_str(), nullptr);
+                double val = std::strtod(std::string(numStr).c_str(), nullptr);
 
                 if (errno == ERANGE || val == HUGE_VAL || val == -HUGE_VAL) {
-                    std::cerr << "\n[Quanta Error] Float Overflow at line " << line << std::endl;
-                    std::cerr << "  Value '" << numStr << "' exceeds the 64-bit Float limit (~1.79e+308)." << std::endl;
+                    report() << "\n[Quanta Error] Float Overflow at line " << line << std::endl;
+                    report() << "  Value '" << numStr << "' exceeds the 64-bit Float limit (~1.79e+308)." << std::endl;
                     // Do NOT exit. Just skip this token.
                     continue; 
                 }
                 
                 // Valid Float
-                tokens.push_back({TOK_FLOAT, numStr, line});
+                return {TOK_FLOAT, line, numStr};
             } 
             else {
                 // --- INTEGER 64-BIT CHECK ---
@@ -246,57 +382,51 @@ std::vector<Token> tokenize(std::string source) {
                     isOverflow = true;
                 } 
                 else if (numStr.length() == 20) {
-                    std::string maxLimit = "18446744073709551615";
+                    std::string_view maxLimit = "18446744073709551615";
                     if (numStr > maxLimit) {
                         isOverflow = true;
                     }
                 }
 
                 if (isOverflow) {
-                    std::cerr << "\n[Quanta Error] Integer Overflow at line " << line << std::endl;
-                    std::cerr << "  Value '" << numStr << "' exceeds the 64-bit Integer limit." << std::endl;
+                    report() << "\n[Quanta Error] Integer Overflow at line " << line << std::endl;
+                    report() << "  Value '" << numStr << "' exceeds the 64-bit Integer limit." << std::endl;
                     // Do NOT exit. Just skip this token.
                     continue; 
                 }
 
                 // Valid Integer
-                tokens.push_back({TOK_NUMBER, numStr, line});
+                return {TOK_NUMBER, line, numStr};
             }
-            continue;
       
         }
 
 
         // --- 8. SYMBOLS ---
         if (c == '=' && i + 1 < source.length() && source[i+1] == '=') {
-            tokens.push_back({TOK_EQ, "==", line});
             i += 2; // Eat both chars
-            continue;
+            return {TOK_EQ, line, "=="};
         }
         // 1. Not Equal (!=)
         if (c == '!' && i + 1 < source.length() && source[i+1] == '=') {
-            tokens.push_back({TOK_NEQ, "!=", line});
             i += 2; 
-            continue;
+            return {TOK_NEQ, line, "!="};
         }
 
         // 2. Greater Than or Equal (>=)
         if (c == '>' && i + 1 < source.length() && source[i+1] == '=') {
-            tokens.push_back({TOK_GEQ, ">=", line});
             i += 2; 
-            continue;
+            return {TOK_GEQ, line, ">="};
         }
 
         // 3. Less Than or Equal (<=)
         if (c == '<' && i + 1 < source.length() && source[i+1] == '=') {
-            tokens.push_back({TOK_LEQ, "<=", line});
             i += 2; 
-            continue;
+            return {TOK_LEQ, line, "<="};
         }
         if (c == '.') {
-            tokens.push_back({TOK_DOT, ".", line}); // <--- NEW: Dot Token
             i++;
-            continue;
+            return {TOK_DOT, line, "."}; // <--- NEW: Dot Token
         }
 
 
@@ -305,15 +435,23 @@ std::vector<Token> tokenize(std::string source) {
             c == '=' || c == '(' || c == ')' || c == '<' || c == '>' || c == ';' || c == '{' || c == '}'|| c == '%'|| 
         c == ',' || c == '[' || c == ']' || c == ':') {
             
-            tokens.push_back({(int)c, std::string(1, c), line});
-            i++;
-            continue;
+            return {(int)c, line, source.substr(i++, 1)};
         }
 
-        std::cerr << "[Quanta Error] Unknown char '" << c << "' at line " << line << std::endl;
-        exit(1);
+        report() << "[Quanta Error] Unknown char '" << c << "' at line " << line << std::endl;
+        if (!Quiet) HasError = true;
+        i++; // Skip it and keep going so every error in the file gets reported
     }
 
-    tokens.push_back({TOK_EOF, "", line});
+    return {TOK_EOF, line, ""};
+}
+
+// Convenience wrapper for callers that want the whole stream at once.
+std::vector<Token> tokenize(std::string_view source) {
+    std::vector<Token> tokens;
+    Lexer lexer(source);
+    do {
+        tokens.push_back(lexer.next());
+    } while (tokens.back().type != TOK_EOF);
     return tokens;
 }
\ No newline at end of file
@@ -0,0 +1,595 @@
+#include "../include/quanta.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/Support/JSON.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+// --- LANGUAGE SERVER ---
+// JSON-RPC over stdin/stdout. Documents are synced incrementally and kept as
+// top-level pieces (see splitTopLevel()). An edit re-lexes from the piece it
+// starts in until the new pieces line up with the old ones again, and only
+// pieces whose text changed are parsed again, plus the pieces that use a
+// function name the edit added or removed. Nothing else is redone, so the
+// cost of a keystroke depends on the function being edited, not on the file.
+//
+// Each document has its own function table. It is swapped in as
+// FunctionRegistry while the document's pieces are parsed, and answers go to
+// definition and signature help. AST arenas only live while a piece is
+// parsed: the table keeps signatures, not nodes.
+// Positions are taken as bytes, which matches UTF-16 for ASCII sources.
+
+namespace {
+
+struct PieceDiagnostic {
+    int Line; // Relative to the piece's Line, so it survives shifts
+    std::string Message;
+};
+
+struct Piece : TopLevelPiece {
+    size_t Length = 0;
+    size_t Hash = 0;
+    bool Parsed = false;
+    FunctionInfo Info;            // Functions: as registered, without AST
+    std::string ReturnType;
+    std::vector<std::string> Params; // "type name" or "type name = ..."
+    std::vector<PieceDiagnostic> Diagnostics;
+};
+
+struct Document {
+    std::string Uri;
+    std::string Dir; // Imports resolve against it
+    std::string Text;
+    std::vector<Piece> Pieces;
+
+    // What the imports provide, and the arenas their signatures live in
+    std::vector<std::unique_ptr<ASTArena>> ImportArenas;
+    std::unordered_map<SymbolID, FunctionInfo> ImportRegistry;
+    std::unordered_set<SymbolID> Modules;
+
+    // ImportRegistry plus every function of the file
+    std::unordered_map<SymbolID, FunctionInfo> Registry;
+};
+
+std::map<std::string, Document> Documents;
+std::ostream Discard(nullptr);
+
+// The document's tables stand in for the compiler's while it is parsed
+struct DocumentScope {
+    Document &Doc;
+    std::string SavedRootDir;
+    explicit DocumentScope(Document &D) : Doc(D), SavedRootDir(RootDir) {
+        std::swap(FunctionRegistry, Doc.Registry);
+        std::swap(LoadedModules, Doc.Modules);
+        RootDir = Doc.Dir;
+    }
+    ~DocumentScope() {
+        std::swap(FunctionRegistry, Doc.Registry);
+        std::swap(LoadedModules, Doc.Modules);
+        RootDir = SavedRootDir;
+    }
+};
+
+size_t pieceEnd(const Document &Doc, size_t I) {
+    return I + 1 < Doc.Pieces.size() ? Doc.Pieces[I + 1].Begin : Doc.Text.size();
+}
+
+std::string_view pieceText(const Document &Doc, size_t I) {
+    return std::string_view(Doc.Text).substr(Doc.Pieces[I].Begin, pieceEnd(Doc, I) - Doc.Pieces[I].Begin);
+}
+
+// Last piece starting at or before Offset (0 if none does)
+size_t pieceAt(const Document &Doc, size_t Offset) {
+    auto It = std::upper_bound(Doc.Pieces.begin(), Doc.Pieces.end(), Offset,
+                               [](size_t O, const Piece &P) { return O < P.Begin; });
+    return It == Doc.Pieces.begin() ? 0 : (It - Doc.Pieces.begin()) - 1;
+}
+
+// --- 1. POSITIONS ---
+// LSP lines count from 0, Quanta's from 1. The piece table doubles as a
+// line index: scan from the last piece that starts on an earlier line (a
+// piece starts after a token, not at the start of its line).
+size_t offsetAt(const Document &Doc, int Line, int Character) {
+    int Target = Line + 1;
+    size_t Offset = 0;
+    int At = 1;
+    auto It = std::lower_bound(Doc.Pieces.begin(), Doc.Pieces.end(), Target,
+                               [](const Piece &P, int L) { return P.Line < L; });
+    if (It != Doc.Pieces.begin()) {
+        Offset = std::prev(It)->Begin;
+        At = std::prev(It)->Line;
+    }
+    while (At < Target) {
+        size_t NL = Doc.Text.find('\n', Offset);
+        if (NL == std::string::npos) return Doc.Text.size();
+        Offset = NL + 1;
+        At++;
+    }
+    size_t LineEnd = Doc.Text.find('\n', Offset);
+    if (LineEnd == std::string::npos) LineEnd = Doc.Text.size();
+    return std::min(Offset + (size_t)std::max(Character, 0), LineEnd);
+}
+
+llvm::json::Value position(int Line, int Character) {
+    return llvm::json::Object{{"line", Line - 1}, {"character", Character}};
+}
+
+// --- 2. PARSING PIECES ---
+// Turns the parser's messages back into one diagnostic per "[Quanta Error]",
+// with the line it names (the piece's first line if it names none).
+std::vector<PieceDiagnostic> collectDiagnostics(const std::string &Text, int FirstLine) {
+    std::vector<PieceDiagnostic> Result;
+    std::istringstream In(Text);
+    std::string L;
+    while (std::getline(In, L)) {
+        size_t Start = L.find_first_not_of(" \t\r");
+        if (Start == std::string::npos) continue;
+        L = L.substr(Start, L.find_last_not_of(" \t\r") + 1 - Start);
+
+        size_t Tag = L.find("[Quanta Error]");
+        if (Tag == std::string::npos && L.rfind("Error", 0) != 0) {
+            if (!Result.empty()) Result.back().Message += "\n" + L; // Continuation line
+            continue;
+        }
+        std::string Message = Tag == std::string::npos ? L : L.substr(Tag + 14);
+        int Line = FirstLine;
+
+        // "... at line N" or "Line N: ..."
+        for (const char *Key : {" at line ", "Line "}) {
+            size_t At = Message.find(Key);
+            if (At == std::string::npos) continue;
+            size_t Digits = At + strlen(Key), End = Digits;
+            while (End < Message.size() && isdigit((unsigned char)Message[End])) End++;
+            if (End == Digits) continue;
+            Line = std::atoi(Message.c_str() + Digits);
+            if (End < Message.size() && Message[End] == ':') End++;
+            Message.erase(At, End - At);
+            break;
+        }
+        Start = Message.find_first_not_of(' ');
+        Message = Start == std::string::npos ? "Error" : Message.substr(Start);
+        Result.push_back({Line - FirstLine, Message});
+    }
+    return Result;
+}
+
+// Parses piece I with the document's tables in place (see DocumentScope)
+void parsePieceOf(Document &Doc, size_t I) {
+    Piece &P = Doc.Pieces[I];
+    ASTArena Arena;
+    std::vector<ASTNode*> Statements;
+    std::ostringstream Diag;
+    FunctionAST *Fn = parsePiece(pieceText(Doc, I), P.Line, P.IsFunction, Arena, Statements, Diag);
+    P.Diagnostics = collectDiagnostics(Diag.str(), P.Line);
+    P.Parsed = true;
+
+    P.Params.clear();
+    if (Fn) {
+        P.ReturnType = Fn->ReturnType;
+        P.Info = FunctionRegistry[Fn->getName()];
+        P.Info.Decl = nullptr;
+        for (ArgInfo &Arg : P.Info.Args) {
+            P.Params.push_back(Arg.Type + " " + symbolName(Arg.Name) + (Arg.DefaultValue ? " = ..." : ""));
+            Arg.DefaultValue = nullptr;
+        }
+    } else {
+        // The signature did not parse: keep the name known, with no details
+        P.ReturnType.clear();
+        P.Info = {P.Name, {}, nullptr};
+    }
+    if (P.IsFunction) FunctionRegistry[P.Name] = P.Info; // Drop the arena's nodes
+}
+
+// Rebuilds the table: imports first, then the file's functions in order
+void rebuildRegistry(Document &Doc) {
+    Doc.Registry = Doc.ImportRegistry;
+    for (const Piece &P : Doc.Pieces)
+        if (P.IsFunction) Doc.Registry[P.Name] = P.Parsed ? P.Info : FunctionInfo{P.Name, {}, nullptr};
+}
+
+void reloadImports(Document &Doc) {
+    std::string SavedRootDir = RootDir;
+    RootDir = Doc.Dir;
+    Doc.ImportArenas.clear();
+    loadImports(Doc.Text, Doc.ImportArenas);
+    Doc.ImportRegistry = std::move(FunctionRegistry);
+    Doc.Modules = std::move(LoadedModules);
+    FunctionRegistry.clear();
+    LoadedModules.clear();
+    RootDir = SavedRootDir;
+}
+
+void measure(Document &Doc, size_t First, size_t Last) {
+    for (size_t I = First; I < Last; I++) {
+        Doc.Pieces[I].Length = pieceEnd(Doc, I) - Doc.Pieces[I].Begin;
+        Doc.Pieces[I].Hash = llvm::hash_value(llvm::StringRef(pieceText(Doc, I).data(), Doc.Pieces[I].Length));
+    }
+}
+
+// Whole document: on open, and for a change that replaces all of it
+void analyzeAll(Document &Doc) {
+    std::vector<TopLevelPiece> Split = splitTopLevel(Doc.Text, 0, 1, [](size_t) { return false; });
+    Doc.Pieces.assign(Split.size(), Piece());
+    for (size_t I = 0; I < Split.size(); I++) static_cast<TopLevelPiece &>(Doc.Pieces[I]) = std::move(Split[I]);
+    measure(Doc, 0, Doc.Pieces.size());
+
+    reloadImports(Doc);
+    rebuildRegistry(Doc);
+    DocumentScope Scope(Doc);
+    for (size_t I = 0; I < Doc.Pieces.size(); I++) parsePieceOf(Doc, I);
+}
+
+// An imported file changed on disk since the imports were read: read them
+// again and re-parse every piece. The check is a stat per module.
+bool refreshImports(Document &Doc) {
+    std::string SavedRootDir = RootDir;
+    RootDir = Doc.Dir;
+    bool Outdated = modulesOutdated(Doc.Modules);
+    RootDir = SavedRootDir;
+    if (!Outdated) return false;
+
+    reloadImports(Doc);
+    rebuildRegistry(Doc);
+    DocumentScope Scope(Doc);
+    for (size_t I = 0; I < Doc.Pieces.size(); I++) parsePieceOf(Doc, I);
+    return true;
+}
+
+// Replaces Text[From, To) with NewText and brings the pieces up to date
+void applyEdit(Document &Doc, size_t From, size_t To, std::string_view NewText) {
+    if (Doc.Pieces.empty()) {
+        Doc.Text.replace(From, To - From, NewText);
+        analyzeAll(Doc);
+        return;
+    }
+    long Delta = (long)NewText.size() - (long)(To - From);
+    int LineDelta = (int)std::count(NewText.begin(), NewText.end(), '\n') -
+                    (int)std::count(Doc.Text.begin() + From, Doc.Text.begin() + To, '\n');
+    Doc.Text.replace(From, To - From, NewText);
+
+    // 1. Re-split from the first piece whose end the lexer decided by
+    // reading text the edit touches (the byte at the horizon counts: a
+    // token ending there may grow), until a piece starts where an old piece
+    // that lies wholly after the edit starts, shifted by Delta
+    size_t A = std::lower_bound(Doc.Pieces.begin(), Doc.Pieces.end(), From,
+                                [](const Piece &P, size_t O) { return P.Horizon < O; }) - Doc.Pieces.begin();
+    if (A == Doc.Pieces.size()) A--;
+    size_t After = A + 1;
+    while (After < Doc.Pieces.size() && Doc.Pieces[After].Begin < To) After++;
+    size_t B = Doc.Pieces.size();
+    std::vector<TopLevelPiece> Split = splitTopLevel(
+        Doc.Text, Doc.Pieces[A].Begin, Doc.Pieces[A].Line, [&](size_t At) {
+            if ((long)At - Delta < (long)To) return false;
+            size_t Old = (size_t)((long)At - Delta);
+            auto It = std::lower_bound(Doc.Pieces.begin() + After, Doc.Pieces.end(), Old,
+                                       [](const Piece &P, size_t O) { return P.Begin < O; });
+            if (It == Doc.Pieces.end() || It->Begin != Old) return false;
+            B = It - Doc.Pieces.begin();
+            return true;
+        });
+
+    // 2. Old pieces [A, B) give way to the new ones. Those whose text did
+    // not change keep their parse (matched from both ends).
+    std::vector<Piece> Fresh(Split.size());
+    for (size_t I = 0; I < Split.size(); I++) static_cast<TopLevelPiece &>(Fresh[I]) = std::move(Split[I]);
+    std::vector<Piece> Old(std::make_move_iterator(Doc.Pieces.begin() + A),
+                           std::make_move_iterator(Doc.Pieces.begin() + B));
+    Doc.Pieces.erase(Doc.Pieces.begin() + A, Doc.Pieces.begin() + B);
+    for (size_t I = A; I < Doc.Pieces.size(); I++) {
+        Doc.Pieces[I].Begin += Delta;
+        Doc.Pieces[I].Horizon += Delta;
+        Doc.Pieces[I].Line += LineDelta;
+    }
+    Doc.Pieces.insert(Doc.Pieces.begin() + A, std::make_move_iterator(Fresh.begin()),
+                      std::make_move_iterator(Fresh.end()));
+    size_t End = A + Split.size();
+    measure(Doc, A, End);
+
+    auto same = [&](const Piece &N, const Piece &O) {
+        return N.Hash == O.Hash && N.Length == O.Length && N.IsFunction == O.IsFunction;
+    };
+    auto keep = [&](Piece &N, Piece &O) {
+        N.Parsed = true;
+        N.Info = std::move(O.Info);
+        N.ReturnType = std::move(O.ReturnType);
+        N.Params = std::move(O.Params);
+        N.Diagnostics = std::move(O.Diagnostics);
+    };
+    size_t Front = 0, Back = 0;
+    while (Front < Split.size() && Front < Old.size() && same(Doc.Pieces[A + Front], Old[Front])) {
+        keep(Doc.Pieces[A + Front], Old[Front]);
+        Front++;
+    }
+    while (Back + Front < Split.size() && Back + Front < Old.size() &&
+           same(Doc.Pieces[End - 1 - Back], Old[Old.size() - 1 - Back])) {
+        keep(Doc.Pieces[End - 1 - Back], Old[Old.size() - 1 - Back]);
+        Back++;
+    }
+
+    // 3. Which function names come and go, and did the imports change?
+    std::vector<SymbolID> Removed, Added;
+    bool ImportsChanged = false;
+    for (size_t I = Front; I + Back < Old.size(); I++) {
+        if (Old[I].IsFunction) Removed.push_back(Old[I].Name);
+        ImportsChanged |= Old[I].HasImport;
+    }
+    for (size_t I = A + Front; I + Back < End; I++) {
+        if (Doc.Pieces[I].IsFunction) Added.push_back(Doc.Pieces[I].Name);
+        ImportsChanged |= Doc.Pieces[I].HasImport;
+    }
+    std::sort(Removed.begin(), Removed.end());
+    std::sort(Added.begin(), Added.end());
+    std::vector<SymbolID> Changed;
+    std::set_symmetric_difference(Removed.begin(), Removed.end(), Added.begin(), Added.end(),
+                                  std::back_inserter(Changed));
+    Changed.erase(std::unique(Changed.begin(), Changed.end()), Changed.end());
+
+    if (ImportsChanged) {
+        reloadImports(Doc);
+        for (Piece &P : Doc.Pieces) P.Parsed = false;
+    }
+    if (ImportsChanged || !Changed.empty()) rebuildRegistry(Doc);
+
+    // 4. Parse what is new, and what calls a name that appeared or vanished
+    DocumentScope Scope(Doc);
+    for (size_t I = 0; I < Doc.Pieces.size(); I++) {
+        Piece &P = Doc.Pieces[I];
+        bool Affected = !P.Parsed;
+        for (size_t K = 0; !Affected && K < Changed.size(); K++)
+            Affected = std::binary_search(P.Identifiers.begin(), P.Identifiers.end(), Changed[K]);
+        if (Affected) parsePieceOf(Doc, I);
+    }
+}
+
+// --- 3. REQUESTS ---
+llvm::json::Value diagnosticsOf(const Document &Doc) {
+    llvm::json::Array Result;
+    for (const Piece &P : Doc.Pieces) {
+        for (const PieceDiagnostic &D : P.Diagnostics) {
+            int Line = P.Line + D.Line;
+            Result.push_back(llvm::json::Object{
+                {"range", llvm::json::Object{{"start", position(Line, 0)}, {"end", position(Line + 1, 0)}}},
+                {"severity", 1},
+                {"source", "quanta"},
+                {"message", llvm::json::fixUTF8(D.Message)}});
+        }
+    }
+    return Result;
+}
+
+std::string identifierAt(const Document &Doc, size_t Offset) {
+    auto isIdent = [](char C) { return isalnum((unsigned char)C) || C == '_'; };
+    size_t Begin = Offset, End = Offset;
+    while (Begin > 0 && isIdent(Doc.Text[Begin - 1])) Begin--;
+    while (End < Doc.Text.size() && isIdent(Doc.Text[End])) End++;
+    return Doc.Text.substr(Begin, End - Begin);
+}
+
+// The last definition wins, as in FunctionRegistry
+const Piece *definitionOf(const Document &Doc, SymbolID Name) {
+    for (size_t I = Doc.Pieces.size(); I-- > 0;)
+        if (Doc.Pieces[I].IsFunction && Doc.Pieces[I].Name == Name) return &Doc.Pieces[I];
+    return nullptr;
+}
+
+llvm::json::Value definition(const Document &Doc, size_t Offset) {
+    std::string Word = identifierAt(Doc, Offset);
+    if (Word.empty()) return nullptr;
+    const Piece *P = definitionOf(Doc, intern(Word));
+    if (!P) return nullptr; // Imported functions carry no source position
+
+    size_t At = P->Begin + P->NameOffset;
+    size_t LineStart = Doc.Text.rfind('\n', At ? At - 1 : 0);
+    int Column = (int)(At - (LineStart == std::string::npos ? 0 : LineStart + 1));
+    int Line = P->Line + P->NameLine;
+    return llvm::json::Object{
+        {"uri", Doc.Uri},
+        {"range", llvm::json::Object{{"start", position(Line, Column)},
+                                     {"end", position(Line, Column + (int)Word.size())}}}};
+}
+
+// The innermost call still open at Offset, and the argument it is on
+llvm::json::Value signatureHelp(const Document &Doc, size_t Offset) {
+    size_t I = pieceAt(Doc, Offset);
+    if (Doc.Pieces.empty()) return nullptr;
+    const Piece &P = Doc.Pieces[I];
+    Lexer L(std::string_view(Doc.Text).substr(P.Begin, Offset - P.Begin), P.Line);
+    L.setQuiet(true);
+
+    struct OpenCall {
+        SymbolID Callee;
+        int Argument;
+    };
+    std::vector<OpenCall> Open;
+    int Previous = TOK_EOF;
+    SymbolID PreviousName = SYM_NONE;
+    for (Token T = L.next(); T.type != TOK_EOF; T = L.next()) {
+        if (T.type == '(') Open.push_back({Previous == TOK_IDENTIFIER ? PreviousName : SYM_NONE, 0});
+        else if (T.type == ')' && !Open.empty()) Open.pop_back();
+        else if (T.type == ',' && !Open.empty()) Open.back().Argument++;
+        Previous = T.type;
+        PreviousName = T.type == TOK_IDENTIFIER ? intern(T.value) : SYM_NONE;
+    }
+    while (!Open.empty() && Open.back().Callee == SYM_NONE) Open.pop_back();
+    if (Open.empty()) return nullptr;
+
+    SymbolID Name = Open.back().Callee;
+    std::string ReturnType;
+    std::vector<std::string> Params;
+    if (const Piece *Def = definitionOf(Doc, Name)) {
+        ReturnType = Def->ReturnType;
+        Params = Def->Params;
+    } else {
+        auto It = Doc.ImportRegistry.find(Name);
+        if (It == Doc.ImportRegistry.end()) return nullptr;
+        if (It->second.Decl) ReturnType = It->second.Decl->ReturnType;
+        for (const ArgInfo &Arg : It->second.Args)
+            Params.push_back(Arg.Type + " " + symbolName(Arg.Name) + (Arg.DefaultValue ? " = ..." : ""));
+    }
+
+    std::string Label = (ReturnType.empty() ? "" : ReturnType + " ") + symbolName(Name) + "(";
+    llvm::json::Array Parameters;
+    for (size_t K = 0; K < Params.size(); K++) {
+        if (K) Label += ", ";
+        Label += Params[K];
+        Parameters.push_back(llvm::json::Object{{"label", Params[K]}});
+    }
+    Label += ")";
+    return llvm::json::Object{
+        {"signatures", llvm::json::Array{llvm::json::Object{{"label", Label}, {"parameters", std::move(Parameters)}}}},
+        {"activeSignature", 0},
+        {"activeParameter", Open.back().Argument}};
+}
+
+// --- 4. TRANSPORT ---
+bool readMessage(std::string &Body) {
+    size_t Length = 0;
+    std::string Header;
+    while (std::getline(std::cin, Header)) {
+        if (!Header.empty() && Header.back() == '\r') Header.pop_back();
+        if (!Header.empty()) {
+            if (Header.rfind("Content-Length:", 0) == 0) Length = std::strtoul(Header.c_str() + 15, nullptr, 10);
+            continue;
+        }
+        if (!Length) continue;
+        Body.resize(Length);
+        return (bool)std::cin.read(&Body[0], Length);
+    }
+    return false;
+}
+
+void send(llvm::json::Object Message) {
+    Message["jsonrpc"] = "2.0";
+    std::string Body;
+    llvm::raw_string_ostream OS(Body);
+    OS << llvm::json::Value(std::move(Message));
+    OS.flush();
+    std::cout << "Content-Length: " << Body.size() << "\r\n\r\n" << Body << std::flush;
+}
+
+void publishDiagnostics(const Document &Doc) {
+    send(llvm::json::Object{{"method", "textDocument/publishDiagnostics"},
+          {"params", llvm::json::Object{{"uri", Doc.Uri}, {"diagnostics", diagnosticsOf(Doc)}}}});
+}
+
+// file:///a/b%20c/x.qnt -> /a/b c/
+std::string directoryOf(llvm::StringRef Uri) {
+    if (!Uri.consume_front("file://")) return "./";
+    std::string Path;
+    for (size_t I = 0; I < Uri.size(); I++) {
+        if (Uri[I] == '%' && I + 2 < Uri.size()) {
+            Path += (char)std::strtol(Uri.substr(I + 1, 2).str().c_str(), nullptr, 16);
+            I += 2;
+        } else {
+            Path += Uri[I];
+        }
+    }
+    size_t Slash = Path.find_last_of('/');
+    return Slash == std::string::npos ? "./" : Path.substr(0, Slash + 1);
+}
+
+} // namespace
+
+int runLsp(const std::vector<std::string> &Args) {
+    if (!Args.empty()) {
+        std::cerr << "Usage: quanta lsp" << std::endl;
+        return 1;
+    }
+    // stdout is the protocol: progress and stray diagnostics go nowhere
+    initializeOperators();
+    setInfoStream(&Discard);
+    setDiagnosticStream(&Discard);
+
+    bool ShuttingDown = false;
+    std::string Body;
+    while (readMessage(Body)) {
+        auto Parsed = llvm::json::parse(Body);
+        if (!Parsed) {
+            llvm::consumeError(Parsed.takeError());
+            continue;
+        }
+        const llvm::json::Object *Message = Parsed->getAsObject();
+        if (!Message) continue;
+        auto Method = Message->getString("method");
+        const llvm::json::Value *Id = Message->get("id");
+        const llvm::json::Object *Params = Message->getObject("params");
+        if (!Method) continue; // A response to us: we send no requests
+
+        auto reply = [&](llvm::json::Value Result) {
+            if (Id) send(llvm::json::Object{{"id", *Id}, {"result", std::move(Result)}});
+        };
+        // The document and position a request is about
+        const llvm::json::Object *TextDocument = Params ? Params->getObject("textDocument") : nullptr;
+        auto Uri = TextDocument ? TextDocument->getString("uri") : decltype(Method)();
+        auto Doc = Uri ? Documents.find(Uri->str()) : Documents.end();
+        auto offsetOf = [&](const llvm::json::Object *Pos) {
+            if (!Pos) return (size_t)0;
+            return offsetAt(Doc->second, (int)Pos->getInteger("line").value_or(0),
+                            (int)Pos->getInteger("character").value_or(0));
+        };
+
+        if (*Method == "initialize") {
+            reply(llvm::json::Object{
+                {"capabilities",
+                 llvm::json::Object{
+                     {"textDocumentSync", llvm::json::Object{{"openClose", true}, {"change", 2}, {"save", true}}},
+                     {"definitionProvider", true},
+                     {"signatureHelpProvider",
+                      llvm::json::Object{{"triggerCharacters", llvm::json::Array{"(", ","}}}}}},
+                {"serverInfo", llvm::json::Object{{"name", "quanta"}}}});
+        } else if (*Method == "shutdown") {
+            ShuttingDown = true;
+            reply(nullptr);
+        } else if (*Method == "exit") {
+            return ShuttingDown ? 0 : 1;
+        } else if (*Method == "textDocument/didOpen" && Uri) {
+            Document &D = Documents[Uri->str()];
+            D = Document();
+            D.Uri = Uri->str();
+            D.Dir = directoryOf(*Uri);
+            if (auto Text = TextDocument->getString("text")) D.Text = Text->str();
+            analyzeAll(D);
+            publishDiagnostics(D);
+        } else if (*Method == "textDocument/didChange" && Doc != Documents.end()) {
+            refreshImports(Doc->second);
+            if (const llvm::json::Array *Changes = Params->getArray("contentChanges")) {
+                for (const llvm::json::Value &C : *Changes) {
+                    const llvm::json::Object *Change = C.getAsObject();
+                    auto Text = Change ? Change->getString("text") : decltype(Method)();
+                    if (!Text) continue;
+                    const llvm::json::Object *Range = Change->getObject("range");
+                    const llvm::json::Object *Start = Range ? Range->getObject("start") : nullptr;
+                    const llvm::json::Object *End = Range ? Range->getObject("end") : nullptr;
+                    if (!Start || !End) {
+                        Doc->second.Text = Text->str();
+                        analyzeAll(Doc->second);
+                        continue;
+                    }
+                    size_t From = offsetOf(Start), To = std::max(From, offsetOf(End));
+                    applyEdit(Doc->second, From, To, std::string_view(Text->data(), Text->size()));
+                }
+            }
+            publishDiagnostics(Doc->second);
+        } else if (*Method == "textDocument/didSave") {
+            // The saved file may be a module other documents import
+            for (auto &Entry : Documents)
+                if (refreshImports(Entry.second)) publishDiagnostics(Entry.second);
+        } else if (*Method == "textDocument/didClose" && Doc != Documents.end()) {
+            Doc->second.Pieces.clear();
+            publishDiagnostics(Doc->second);
+            Documents.erase(Doc);
+        } else if (*Method == "textDocument/definition") {
+            reply(Doc != Documents.end() ? definition(Doc->second, offsetOf(Params->getObject("position")))
+                                         : llvm::json::Value(nullptr));
+        } else if (*Method == "textDocument/signatureHelp") {
+            reply(Doc != Documents.end() ? signatureHelp(Doc->second, offsetOf(Params->getObject("position")))
+                                         : llvm::json::Value(nullptr));
+        } else if (Id) {
+            send(llvm::json::Object{{"id", *Id},
+                  {"error", llvm::json::Object{{"code", -32601}, {"message", "Unsupported method " + Method->str()}}}});
+        }
+    }
+    return ShuttingDown ? 0 : 1;
+}
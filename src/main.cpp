@@ -1,6 +1,4 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
 
 // LLVM Headers
@@ -10,21 +8,131 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/FileSystem.h"
 
 #include "../include/quanta.h"
-std::string RootDir = "./";
-
-// --- GLOBAL DEFINITIONS ---
-std::unique_ptr<llvm::LLVMContext> TheContext;
-std::unique_ptr<llvm::Module> TheModule;
-std::unique_ptr<llvm::IRBuilder<>> Builder;
+std::string RuntimeSource = "../src/quanta_lib.c";
 
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: quanta <file.qnt>" << std::endl;
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (!args.empty() && args[0] == "--server") {
+        return runServer(args.size() > 1 ? args[1] : "");
+    }
+    // Reads the terminal, so unlike 'build' it is not offered by the server
+    if (!args.empty() && args[0] == "repl") {
+        return runRepl(std::vector<std::string>(args.begin() + 1, args.end()));
+    }
+    if (!args.empty() && args[0] == "lsp") {
+        return runLsp(std::vector<std::string>(args.begin() + 1, args.end()));
+    }
+    return runQuanta(args);
+}
+
+// Compiles quanta_lib.c once; links then only need the object
+bool prebuildRuntime(const std::string &Object) {
+    llvm::SmallString<128> Resolved;
+    if (llvm::sys::fs::real_path(RuntimeSource, Resolved)) {
+        std::cerr << "[INFO] Runtime " << RuntimeSource << " not found; every link will look for it" << std::endl;
+        return false;
+    }
+    std::string Command = "clang -g -c " + std::string(Resolved) + " -o " + Object;
+    if (system(Command.c_str()) != 0) {
+        std::cerr << "[INFO] Could not prebuild the runtime; every link will compile it" << std::endl;
+        return false;
+    }
+    RuntimeSource = Object;
+    return true;
+}
+
+// Code generation flags, shared by 'quanta' and 'quanta build'
+int parseCodegenFlag(const std::vector<std::string> &Args, size_t &I, CompileOptions &Opts) {
+    const std::string &arg = Args[I];
+    if (arg == "--stream") {
+        Opts.Stream = true;
+    } else if (arg == "-O") {
+        Opts.Optimize = true;
+    } else if (arg == "--split") {
+        if (I + 1 >= Args.size() || (Opts.SplitEvery = std::atoi(Args[++I].c_str())) == 0) {
+            std::cerr << "Error: --split expects a positive function count" << std::endl;
+            return -1;
+        }
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// One whole compile-link-run, as for the command line 'quanta <Args>'
+int runQuanta(const std::vector<std::string> &Args) {
+    if (!Args.empty() && Args[0] == "build") {
+        return runBuild(std::vector<std::string>(Args.begin() + 1, Args.end()));
+    }
+    StackReport = false;
+    SizeReport = false;
+
+    // Flags may appear anywhere; the first non-flag argument is the source file.
+    CompileOptions opts;
+    for (size_t i = 0; i < Args.size(); i++) {
+        const std::string &arg = Args[i];
+        int handled = parseCodegenFlag(Args, i, opts);
+        if (handled < 0) return 1;
+        if (handled) continue;
+
+        if (arg == "--stack-report") {
+            StackReport = true;
+        } else if (arg == "--tiered") {
+            opts.Tiered = true;
+        } else if (arg == "--tier-up") {
+            if (i + 1 >= Args.size() || (opts.TierUpAt = std::atoi(Args[++i].c_str())) == 0) {
+                std::cerr << "Error: --tier-up expects a positive count" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--size-report") {
+            SizeReport = true;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Error: Unknown option " << arg << std::endl;
+            return 1;
+        } else if (opts.Source.empty()) {
+            opts.Source = arg;
+        }
+    }
+    if (opts.Source.empty()) {
+        std::cerr << "Usage: quanta [--stream] [--split N] [-O] [--stack-report] [--size-report] <file.qnt>" << std::endl;
+        std::cerr << "       quanta --tiered [--tier-up N] [-O] <file.qnt>" << std::endl;
+        std::cerr << "       quanta build [--stream] [--split N] [-O] [-j N] [-o outdir] <files or dirs>" << std::endl;
+        std::cerr << "       quanta repl [-O]" << std::endl;
+        std::cerr << "       quanta lsp" << std::endl;
+        std::cerr << "       quanta --server [socket]" << std::endl;
+        return 1;
+    }
+    if (opts.SplitEvery && (StackReport || SizeReport)) {
+        // Both reports look at the one module that produced the image
+        std::cerr << "Error: --split cannot be combined with --stack-report or --size-report" << std::endl;
+        return 1;
+    }
+    if (opts.Tiered && (opts.Stream || opts.SplitEvery || StackReport || SizeReport)) {
+        // Tiered runs need every body and the whole module, and build no image
+        std::cerr << "Error: --tiered cannot be combined with --stream, --split or the reports" << std::endl;
         return 1;
     }
-    std::string filepath = argv[1];
+    return compileProgram(opts);
+}
+
+// --split: output.o becomes output.1.o, output.2.o, ...
+static std::string splitObjectName(const std::string &Object, size_t Index) {
+    std::string Stem = Object;
+    if (Stem.size() > 2 && Stem.compare(Stem.size() - 2, 2, ".o") == 0) Stem.resize(Stem.size() - 2);
+    return Stem + "." + std::to_string(Index) + ".o";
+}
+
+int compileProgram(const CompileOptions &opts) {
+    const std::string &filepath = opts.Source;
+    bool stream = opts.Stream;
+    bool optimize = opts.Optimize;
+    unsigned splitEvery = opts.SplitEvery;
+
+    RootDir = "./";
     size_t lastSlash = filepath.find_last_of("/\\");
     if (lastSlash != std::string::npos) {
         RootDir = filepath.substr(0, lastSlash + 1);
@@ -32,52 +140,26 @@ int main(int argc, char* argv[]) {
     
 
 
-    BinopPrecedence['<'] = 10;
-    BinopPrecedence['>'] = 10;
-    BinopPrecedence['+'] = 20;
-    BinopPrecedence['-'] = 20;
-    BinopPrecedence['*'] = 40;
-    BinopPrecedence['/'] = 40;
-    BinopPrecedence[TOK_GEQ] = 10;  // >=
-    BinopPrecedence[TOK_LEQ] = 10;  // <=
-    BinopPrecedence[TOK_NEQ] = 5;   // !=
-    BinopPrecedence['%'] = 40;
-    
-    // [FIX] Add this line!
-    BinopPrecedence[TOK_EQ] = 5;
-   
+    initializeOperators();
 
-    // 1. Read the Source File
-    std::ifstream file(argv[1]);
-    if (!file) {
-        std::cerr << "Error: Could not open file " << argv[1] << std::endl;
+    // 1. Map the Source File (tokens point straight into this buffer)
+    auto buffer = llvm::MemoryBuffer::getFile(filepath, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (!buffer) {
+        std::cerr << "Error: Could not open file " << filepath << std::endl;
         return 1;
     }
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string source = buffer.str();
+    std::string_view source((*buffer)->getBufferStart(), (*buffer)->getBufferSize());
 
     // 2. Initialize
     initializeModule();
     
-    // 3. Tokenize
-    auto tokens = tokenize(source);
-
-    // std::cout << "\n[TRACE] 1. LEXER OUTPUT:" << std::endl;
-    // std::cout << "--------------------------------" << std::endl;
-    // for (const auto& t : tokens) {
-    //     // Print Token Type and Value
-    //     std::cout << "Token Type: " << t.type << " | Value: '" << t.value << "'" << std::endl;
-    // }
-    // std::cout << "--------------------------------\n" << std::endl;
-
-    // 4. Parse
-    // FIX: parse() now returns a single 'FunctionAST' pointer, NOT a vector.
-    ProgramAST program = parse(tokens);
+    // 3. Lex + Parse (the parser pulls tokens from the lexer as it goes)
+    Lexer lexer(source);
+    ProgramAST program = stream ? beginStream(lexer) : parse(lexer);
 
    
 
-if (HasError) {
+if (HasError && !stream) {
         std::cerr << "\n\033[1;31m[Fatal]\033[0m Parsing failed. Aborting." << std::endl;
         return 1;
     }
@@ -85,17 +167,57 @@ if (HasError) {
 
     // 5. Compile AST to IR
     bool foundMain = false;
+    std::vector<std::string> objects; // --split: every module emitted so far
+    unsigned inModule = 0;
 
-    // Loop through every function (main, add, etc.)
-    for (const auto& func : program.functions) {
+    auto compileFunction = [&](FunctionAST *func) {
         // Check if we found 'main'
-        if (func->getName() == "main") {
+        if (func->getName() == SYM_MAIN) {
             foundMain = true;
         }
 
         // Generate IR for this function
-        if (!func->codegen()) {
-            std::cerr << "[ERROR] Code Generation failed for function: " << func->getName() << std::endl;
+        llvm::Function *F = func->codegen();
+        if (!F) {
+            std::cerr << "[ERROR] Code Generation failed for function: " << symbolName(func->getName()) << std::endl;
+            return false;
+        }
+        if (optimize) optimizeFunction(*F);
+
+        // Emit the module once it holds N functions and carry on in a fresh one
+        if (splitEvery && ++inModule == splitEvery && !HasError) {
+            std::string object = splitObjectName(opts.Object, objects.size() + 1);
+            if (!emitObjectFile(object)) return false;
+            std::cout << "[Success] Native object file '" << object << "' created!" << std::endl;
+            objects.push_back(object);
+            startNewModule("QuantaModule." + std::to_string(objects.size() + 1));
+            inModule = 0;
+        }
+        return true;
+    };
+
+    if (!stream) {
+        // Loop through every function (main, add, etc.)
+        for (const auto& func : program.functions) {
+            if (!compileFunction(func)) return 1;
+        }
+    } else {
+        // Only one body is alive at a time: its nodes go with bodyArena
+        bool parseFailed = HasError;
+        while (true) {
+            ASTArena bodyArena;
+            bool failedBefore = HasError; // Codegen errors are only reported at the end
+            FunctionAST *func = nextStreamedFunction(bodyArena);
+            if (!func) break;
+            if (HasError && !failedBefore) parseFailed = true;
+            // After a syntax error the rest is only parsed, to report it too
+            if (parseFailed) continue;
+            if (!compileFunction(func)) return 1;
+            std::vector<ASTNode*>().swap(func->Body);
+        }
+        endStream(program);
+        if (parseFailed) {
+            std::cerr << "\n\033[1;31m[Fatal]\033[0m Parsing failed. Aborting." << std::endl;
             return 1;
         }
     }
@@ -110,20 +232,53 @@ if (HasError) {
         return 1; // STOP HERE! Do not generate object code.
     }
 
-    // 6. Generate Object File
-    generateObjectCode();
+    // 6. Run in this process instead (--tiered)
+    if (opts.Tiered) {
+        std::cout << "SUCCESS! Running program (tiered)..." << std::endl;
+        std::cout << "------------------------------------" << std::endl;
+        int exitCode = runTiered(program, opts.TierUpAt);
+        std::cout << "\n------------------------------------" << std::endl;
+        if (exitCode < 0) return 1;
+        std::cout << "Program exited with code: " << exitCode << std::endl;
+        return 0;
+    }
+
+    // 7. Generate Object File
+    if (!splitEvery) {
+        if (!generateObjectCode(opts.Object)) return 1;
+        objects.push_back(opts.Object);
+    } else if (inModule) {
+        std::string object = splitObjectName(opts.Object, objects.size() + 1);
+        if (!emitObjectFile(object)) return 1;
+        std::cout << "[Success] Native object file '" << object << "' created!" << std::endl;
+        objects.push_back(object);
+    }
     // TheModule->print(llvm::errs(), nullptr);
+    if (StackReport) {
+        printStackReport();
+    }
     
-    // 7. Link and Auto-Run
+    // 8. Link and Auto-Run
     std::cout << "[INFO] Compiling object code..." << std::endl;
     // int linkResult = system("clang -g output.o -o my_quanta_app");
-    int linkResult = system("clang -g output.o ../src/quanta_lib.c -o my_quanta_app");
+    std::string linkCommand = "clang -g";
+    for (const std::string &object : objects) linkCommand += " " + object;
+    linkCommand += " " + RuntimeSource + " -o " + opts.Executable;
+    int linkResult = system(linkCommand.c_str());
+    if (!opts.KeepObjects) {
+        for (const std::string &object : objects) llvm::sys::fs::remove(object);
+    }
     
     if (linkResult == 0) {
+        if (SizeReport) {
+            printSizeReport(opts.Executable);
+        }
+        if (!opts.Run) return 0;
         std::cout << "SUCCESS! Running program..." << std::endl;
         std::cout << "------------------------------------" << std::endl;
 
-        int exitCode = system("./my_quanta_app");
+        bool bareName = opts.Executable.find_first_of("/\\") == std::string::npos;
+        int exitCode = system(((bareName ? "./" : "") + opts.Executable).c_str());
         int actualReturn = exitCode >> 8;
         
         std::cout << "\n------------------------------------" << std::endl;
@@ -3,79 +3,179 @@
 #include <string>
 #include <iostream>
 #include <memory>
-#include <fstream>
 #include <sstream>
-#include <set>
+#include <deque>
+#include <mutex>
+#include <algorithm>
+#include <cctype>
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Parallel.h"
 
 // --- 1. GLOBAL DEFINITIONS ---
 // These MUST exist here because they were marked 'extern' in quanta.h
 
-std::set<std::string> LoadedModules;
-std::map<std::string, FunctionInfo> FunctionRegistry; // Matches your quanta.h type
-std::vector<std::unique_ptr<FunctionAST>> ImportedFunctionsHook;
-
-// --- 2. FORWARD DECLARATIONS ---
-// Tells the compiler these functions exist later in the file
-bool isFunctionDefinition(); 
-std::unique_ptr<FunctionAST> parseFunction();
-extern std::vector<Token> tokenize(std::string source); 
+std::string RootDir = "./";
+std::unordered_set<SymbolID> LoadedModules;
+std::unordered_map<SymbolID, FunctionInfo> FunctionRegistry; // Matches your quanta.h type
+std::vector<FunctionAST*> ImportedFunctionsHook;
 
 // --- 3. HELPER FUNCTIONS ---
-bool readFile(const std::string& filename, std::string& content) {
-    std::string fullPath = RootDir + filename;
-    std::ifstream file(fullPath);
+// Maps the module into memory. Tokens are views into this buffer, so it must
+// outlive every token produced from it.
+std::unique_ptr<llvm::MemoryBuffer> readFile(const std::string& filename) {
+    auto buffer = llvm::MemoryBuffer::getFile(RootDir + filename, /*IsText=*/false, /*RequiresNullTerminator=*/false);
     
-    if (!file.is_open()) {
+    if (!buffer) {
         // Try current directory as fallback
-        file.open(filename);
+        buffer = llvm::MemoryBuffer::getFile(filename, /*IsText=*/false, /*RequiresNullTerminator=*/false);
     }
 
-    if (!file.is_open()) return false;
-
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    content = buffer.str();
-    return true;
+    if (!buffer) return nullptr;
+    return std::move(*buffer);
 }
 
 std::map<int, int> BinopPrecedence;
-// Forward Declaration
-std::unique_ptr<ASTNode> parseBinOpRHS(int ExprPrec, std::unique_ptr<ASTNode> LHS);
+
+void initializeOperators() {
+    BinopPrecedence['<'] = 10;
+    BinopPrecedence['>'] = 10;
+    BinopPrecedence['+'] = 20;
+    BinopPrecedence['-'] = 20;
+    BinopPrecedence['*'] = 40;
+    BinopPrecedence['/'] = 40;
+    BinopPrecedence[TOK_GEQ] = 10;  // >=
+    BinopPrecedence[TOK_LEQ] = 10;  // <=
+    BinopPrecedence[TOK_NEQ] = 5;   // !=
+    BinopPrecedence['%'] = 40;
+    
+    // [FIX] Add this line!
+    BinopPrecedence[TOK_EQ] = 5;
+}
 // --- STATE MANAGEMENT ---
-int currentToken = 0;
-std::vector<Token> globalTokens;
-bool HasError = false;
-
-std::unique_ptr<ASTNode> parseVarDecl();
-std::unique_ptr<ASTNode> parsePrint();
-std::vector<std::unique_ptr<ASTNode>> parseBlock();
-std::unique_ptr<ASTNode> parseIfExpr();
-std::unique_ptr<ASTNode> parseExpression();
-std::unique_ptr<ASTNode> parseUnary();
-std::unique_ptr<FunctionAST> parseFunction();
-
-
-Token getTok() {
-    if (currentToken < globalTokens.size()) return globalTokens[currentToken];
-    int lastLine = (!globalTokens.empty()) ? globalTokens.back().line : 1;
-    return {TOK_EOF, "", lastLine};
+// The parser pulls tokens from the Lexer on demand and only keeps a tiny ring
+// buffer of lookahead. The deepest peek is isFunctionDefinition() ('const',
+// type, name, '('), keyword arguments need two (name, '='), so four slots do.
+static const unsigned LOOKAHEAD = 4;
+struct TokenWindow {
+    Lexer *Lex = nullptr;
+    Token Ring[LOOKAHEAD] = {};
+    unsigned Head = 0;  // Slot of the current token
+    unsigned Count = 0; // Tokens already pulled into the ring
+};
+std::atomic<bool> HasError{false};
+
+// Null means std::cerr; parse tasks on worker threads point this at a buffer.
+static thread_local std::ostream *DiagOut = nullptr;
+std::ostream &diag() { return DiagOut ? *DiagOut : std::cerr; }
+
+// Null means std::cout
+static thread_local std::ostream *InfoOut = nullptr;
+std::ostream &info() { return InfoOut ? *InfoOut : std::cout; }
+
+std::ostream *setDiagnosticStream(std::ostream *Diag) { return std::exchange(DiagOut, Diag); }
+std::ostream *setInfoStream(std::ostream *Info) { return std::exchange(InfoOut, Info); }
+
+thread_local ASTArena *CurrentArena = nullptr;
+
+struct ModuleUnit;
+struct DeferredBody;
+
+// --- PARSER ---
+// One Parser per parse task: the top level of the main file, each imported
+// module, each function body handed to a worker (see parseBodies()). Tasks
+// run concurrently, so everything a parse mutates lives in here; the shared
+// tables (FunctionRegistry, LoadedModules, ImportGraph) are only read while
+// tasks run. diag() and makeNode() stay thread-local so the lexer and the AST
+// helpers need no parser handle: a Parser redirects them for its lifetime.
+class Parser {
+    TokenWindow Window;
+    ModuleUnit *CurrentModule;                 // Null for the main file
+    std::vector<SymbolID> *CallSink = nullptr; // Gets the callee of every call built
+    unsigned VisibleFunctions = ~0u;           // See isKnownFunction()
+
+    std::ostream *SavedDiag;
+    ASTArena *SavedArena;
+
+public:
+    Parser(Lexer &L, ASTArena &Arena, std::ostream *Diag = nullptr, ModuleUnit *Module = nullptr)
+        : CurrentModule(Module), SavedDiag(DiagOut), SavedArena(CurrentArena) {
+        Window.Lex = &L;
+        DiagOut = Diag;
+        CurrentArena = &Arena;
+    }
+    ~Parser() {
+        DiagOut = SavedDiag;
+        CurrentArena = SavedArena;
+    }
+    Parser(const Parser&) = delete;
+    Parser &operator=(const Parser&) = delete;
+
+    void setCallSink(std::vector<SymbolID> *Sink) { CallSink = Sink; }
+    void setVisibleFunctions(unsigned Count) { VisibleFunctions = Count; }
+
+    // Token cursor
+    const Token &peekTok(unsigned N);
+    const Token &getTok();
+    void advance();
+
+    ASTNode *LogError(const std::string& msg);
+    void synchronize();
+    int GetTokPrecedence();
+
+    void registerFunction(SymbolID Name, std::vector<ArgInfo> Args, FunctionAST *Decl);
+    bool isKnownFunction(SymbolID Name);
+    void parseImport();
+    void skipBlock();
+    bool deferFunction(DeferredBody &D);
+
+    bool isFunctionDefinition();
+    FunctionAST *parseFunctionSignature();
+    ASTNode *parseStatement();
+    std::vector<ASTNode*> parseBlock();
+    ASTNode *parseIfExpr();
+    ASTNode *parseLoop();
+    ASTNode *parseVarDecl();
+    ASTNode *parsePrint();
+    ASTNode *parseExpression();
+    ASTNode *parseBinOpRHS(int ExprPrec, ASTNode *LHS);
+    ASTNode *parseUnary();
+    ASTNode *parsePostfix();
+    ASTNode *parsePrimary();
+};
+
+
+// Looks N tokens ahead without consuming anything (N < LOOKAHEAD).
+// The Lexer keeps returning TOK_EOF at the end, so this never runs dry.
+const Token &Parser::peekTok(unsigned N) {
+    while (Window.Count <= N) {
+        Window.Ring[(Window.Head + Window.Count) % LOOKAHEAD] = Window.Lex->next();
+        Window.Count++;
+    }
+    return Window.Ring[(Window.Head + N) % LOOKAHEAD];
 }
 
-void advance() { currentToken++; }
+const Token &Parser::getTok() { return peekTok(0); }
+
+void Parser::advance() {
+    peekTok(0); // Make sure there is something to consume
+    Window.Head = (Window.Head + 1) % LOOKAHEAD;
+    Window.Count--;
+}
 
 // Forward Declaration
 
 
 // 1. Log Error but don't exit
-std::unique_ptr<ASTNode> LogError(const std::string& msg) {
-    Token t = getTok();
-    std::cerr << "[Quanta Error] " << msg << " at line " << t.line << std::endl;
+ASTNode *Parser::LogError(const std::string& msg) {
+    const Token &t = getTok();
+    diag() << "[Quanta Error] " << msg << " at line " << t.line << std::endl;
     HasError = true;
     
     return nullptr; // Return null so the parser knows this failed
 }
 // --- ERROR RECOVERY ---
-void synchronize() {
+void Parser::synchronize() {
     // 1. Remember the line where the error happened
     int errorLine = getTok().line;
 
@@ -83,7 +183,7 @@ void synchronize() {
     while (getTok().type != TOK_EOF) {
         
         // CASE A: Found a semicolon? Eat it and stop. We are synchronized.
-        if (getTok().value == ";") {
+        if (getTok().type == ';') {
             advance();
             return;
         }
@@ -110,19 +210,97 @@ void synchronize() {
 
 
 // --- Get Precedence of Current Token ---
-int GetTokPrecedence() {
+int Parser::GetTokPrecedence() {
     int type = getTok().type;
     
     // Look up in the global map defined in main.cpp
-    // This works for chars ('+') and negative tokens (TOK_EQ = -15)
-    int TokPrec = BinopPrecedence[type];
+    // This works for chars ('+') and negative tokens (TOK_EQ = -15).
+    // find(), not operator[]: the map is shared by the import workers.
+    auto It = BinopPrecedence.find(type);
     
     // If not found or <= 0, it's not a binary operator
-    if (TokPrec <= 0) return -1;
-    return TokPrec;
+    if (It == BinopPrecedence.end() || It->second <= 0) return -1;
+    return It->second;
+}
+
+// --- MODULE IMPORTS ---
+// Imports are resolved before the importing file is parsed. A lex-only scan
+// discovers the whole import graph, then modules are parsed in waves (every
+// module whose imports are already done) on the LLVM thread pool. Each worker
+// has its own token window, diagnostics buffer and function table, and the
+// results are merged into the globals in discovery order, so the outcome and
+// the output do not depend on thread timing.
+
+struct ImportRequest {
+    SymbolID Module;
+    SymbolID Func; // SYM_NONE for 'import mod' and 'import mod.all'
+};
+
+// A function whose signature is parsed but whose body so far is only found
+// by brace matching: the '{' token, a view into a buffer ending at SourceEnd.
+struct DeferredBody {
+    FunctionAST *Fn;                 // Signature only until the body is parsed
+    Token BodyStart;
+    const char *SourceEnd;
+    ModuleUnit *Module = nullptr;    // Null for the main file
+    unsigned Ordinal = ~0u;          // Main file: position among its functions
+    std::vector<SymbolID> Callees;   // Calls seen in default values and the body
+    std::string Diagnostics;
+};
+
+// An imported function whose body is only parsed if the program reaches it
+struct LazyFunction : DeferredBody {
+    bool Queued = false;
+    bool Emitted = false;
+};
+
+struct ModuleUnit {
+    SymbolID Name;
+    std::string Filename;
+    std::shared_ptr<llvm::MemoryBuffer> Source; // Null if the file is missing
+    std::vector<ImportRequest> Imports;
+    std::unique_ptr<ASTArena> Arena = std::make_unique<ASTArena>(); // Handed to the program
+
+    // What the importers asked for: everything, or just these functions
+    bool ImportAll = false;
+    std::unordered_set<SymbolID> Wanted;
+
+    // Filled in by the worker that parses the module
+    std::vector<LazyFunction> Functions;
+    std::unordered_map<SymbolID, FunctionInfo> Registry; // Every function in the file
+    std::unordered_map<SymbolID, LazyFunction*> Lazy;    // The same, by body; set on merge
+    std::string Diagnostics;
+    bool Done = false;
+};
+
+// Modules of the parse in progress (discovery order). They stay alive until
+// parse() returns, since lazily parsed bodies still point into their sources.
+static std::vector<std::unique_ptr<ModuleUnit>> ImportedUnits;
+
+// Modules found on disk for the parse in progress (read-only while parsing)
+static std::unordered_map<SymbolID, ModuleUnit*> ImportGraph;
+
+// Definition order of the main file's functions. A main-file body only sees
+// the functions defined up to and including itself, as it would if the file
+// were parsed top to bottom.
+static std::unordered_map<SymbolID, unsigned> MainFileOrder;
+
+// Workers register into their module's own table; the merge publishes it.
+void Parser::registerFunction(SymbolID Name, std::vector<ArgInfo> Args, FunctionAST *Decl) {
+    auto &Table = CurrentModule ? CurrentModule->Registry : FunctionRegistry;
+    Table[Name] = {Name, std::move(Args), Decl};
+}
+
+bool Parser::isKnownFunction(SymbolID Name) {
+    if (CurrentModule && CurrentModule->Registry.count(Name)) return true;
+    if (!CurrentModule) {
+        auto It = MainFileOrder.find(Name);
+        if (It != MainFileOrder.end() && It->second > VisibleFunctions) return false;
+    }
+    return FunctionRegistry.count(Name) != 0;
 }
 
-void parseImport() {
+void Parser::parseImport() {
     advance(); // Eat 'import'
 
     // 1. Get Module Name
@@ -130,24 +308,23 @@ void parseImport() {
         LogError("Expected module name after 'import'");
         return;
     }
-    std::string ModuleName = getTok().value;
+    std::string ModuleName(getTok().value);
+    SymbolID ModuleSym = intern(ModuleName);
     advance(); // Eat module name
 
     // 2. Check for Specific Import (e.g., .all or .functionName)
-    std::string SpecificFunc = "";
-    bool ImportAll = false;
+    SymbolID SpecificFunc = SYM_NONE;
 
     if (getTok().type == TOK_DOT) {
         advance(); // Eat '.'
         
         // Handle 'all' keyword
         if (getTok().type == TOK_ALL || getTok().value == "all") { 
-            ImportAll = true;
             advance(); // Eat 'all'
         } 
         // Handle specific identifier
         else if (getTok().type == TOK_IDENTIFIER) {
-            SpecificFunc = getTok().value;
+            SpecificFunc = intern(getTok().value);
             advance(); // Eat function name
         } 
         else {
@@ -156,188 +333,469 @@ void parseImport() {
         }
     }
 
-    // 3. Prevent Double Loading
-    std::string Filename = ModuleName + ".qnt";
-    
-    // If already loaded, we just verify the specific function if needed
-    if (LoadedModules.find(Filename) != LoadedModules.end()) {
-        if (!SpecificFunc.empty()) {
-             if (FunctionRegistry.find(SpecificFunc) == FunctionRegistry.end()) {
-                 LogError(("Import Error: Function '" + SpecificFunc + "' not found in module '" + ModuleName + "'").c_str());
-            }
+    // 3. The module itself was already loaded by resolveImports()
+    if (!LoadedModules.count(ModuleSym) && !ImportGraph.count(ModuleSym)) {
+        LogError(("Module not found: " + ModuleName + ".qnt").c_str());
+        return;
+    }
+
+    // 4. FINAL VERIFICATION: Did the file actually contain the specific function?
+    if (SpecificFunc != SYM_NONE && !isKnownFunction(SpecificFunc)) {
+        LogError(("Import Error: Function '" + symbolName(SpecificFunc) + "' not found in module '" + ModuleName + "'").c_str());
+    }
+}
+
+// Lex-only pass that lists a file's imports (lexer errors are left to the
+// real parse).
+static std::vector<ImportRequest> scanImports(Lexer L) {
+    L.setQuiet(true);
+    std::vector<ImportRequest> Imports;
+    Token T = L.next();
+    while (T.type != TOK_EOF) {
+        if (T.type != TOK_IMPORT) { T = L.next(); continue; }
+
+        T = L.next();
+        if (T.type != TOK_IDENTIFIER) continue;
+        ImportRequest R{intern(T.value), SYM_NONE};
+
+        T = L.next();
+        if (T.type == TOK_DOT) {
+            T = L.next();
+            if (T.type == TOK_IDENTIFIER && T.value != "all") R.Func = intern(T.value);
+            if (T.type == TOK_IDENTIFIER || T.type == TOK_ALL) T = L.next();
         }
-        return; 
+        Imports.push_back(R);
     }
+    return Imports;
+}
 
-    // 4. Read the file content
-    std::string NewSource;
-    if (!readFile(Filename, NewSource)) {
-        LogError(("Module not found: " + Filename).c_str());
-        return;
+// --- MODULE CACHE ---
+// A module's source and import list depend only on its file, so each file is
+// read and scanned once per process and shared by every program compiled in
+// it. quanta build preloads the imports of all its programs before it forks
+// the compiles, so they all start from the same cache. The REPL and the
+// language server outlive edits to the file, so an entry is only reused
+// while the file's modification time and size are unchanged.
+struct ModuleFile {
+    std::unique_ptr<llvm::MemoryBuffer> Buffer;
+    std::vector<ImportRequest> Imports;
+    llvm::sys::TimePoint<> Modified;
+    uint64_t Size = 0;
+};
+static std::mutex ModuleCacheLock;
+static std::unordered_map<std::string, std::shared_ptr<ModuleFile>> ModuleCache;
+
+// Looks where readFile() does: next to the program, then the current directory
+static bool statModuleFile(const std::string &Filename, llvm::sys::fs::file_status &Status) {
+    return !llvm::sys::fs::status(RootDir + Filename, Status) || !llvm::sys::fs::status(Filename, Status);
+}
+
+static bool isCurrent(const ModuleFile &File, const llvm::sys::fs::file_status &Status) {
+    return File.Modified == Status.getLastModificationTime() && File.Size == Status.getSize();
+}
+
+// Null if the file is missing (that is not cached: it may show up later)
+static std::shared_ptr<ModuleFile> loadModuleFile(const std::string &Filename) {
+    std::string Key = RootDir + Filename;
+    llvm::sys::fs::file_status Status;
+    if (!statModuleFile(Filename, Status)) return nullptr;
+    {
+        std::lock_guard<std::mutex> Guard(ModuleCacheLock);
+        auto It = ModuleCache.find(Key);
+        if (It != ModuleCache.end() && isCurrent(*It->second, Status)) return It->second;
     }
+    // Stamped before reading: a write in between only causes another reload
+    auto File = std::make_shared<ModuleFile>();
+    File->Modified = Status.getLastModificationTime();
+    File->Size = Status.getSize();
+    File->Buffer = readFile(Filename);
+    if (!File->Buffer) return nullptr;
+    File->Imports = scanImports(Lexer(std::string_view(File->Buffer->getBufferStart(), File->Buffer->getBufferSize())));
+
+    std::lock_guard<std::mutex> Guard(ModuleCacheLock);
+    std::shared_ptr<ModuleFile> &Entry = ModuleCache[Key];
+    // First one in wins a race; a newer read replaces a stale entry
+    if (!Entry || !isCurrent(*Entry, Status)) Entry = File;
+    return Entry;
+}
 
-    // 5. CONTEXT SWITCH (Pause current file -> Parse new file -> Resume)
-    std::vector<Token> OldTokens = globalTokens;
-    int OldPos = currentToken;
+bool modulesOutdated(const std::unordered_set<SymbolID> &Modules) {
+    for (SymbolID Module : Modules) {
+        std::string Filename = symbolName(Module) + ".qnt";
+        llvm::sys::fs::file_status Status;
+        if (!statModuleFile(Filename, Status)) return true; // Gone: the import now fails
+        std::lock_guard<std::mutex> Guard(ModuleCacheLock);
+        auto It = ModuleCache.find(RootDir + Filename);
+        if (It == ModuleCache.end() || !isCurrent(*It->second, Status)) return true;
+    }
+    return false;
+}
 
-    globalTokens = tokenize(NewSource);
-    currentToken = 0;
-    
-    // Mark as loaded before parsing to handle circular imports
-    LoadedModules.insert(Filename); 
-    std::cout << "[Quanta] Importing " << Filename << "..." << std::endl;
+// Single-threaded on purpose: quanta build forks right after, and LLVM's
+// thread pool must not be running by then.
+void preloadImports(const std::string &SourcePath) {
+    auto Buffer = llvm::MemoryBuffer::getFile(SourcePath, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (!Buffer) return;
+
+    // Imports resolve against the program's directory, as in compileProgram()
+    std::string SavedRootDir = RootDir;
+    size_t LastSlash = SourcePath.find_last_of("/\\");
+    RootDir = LastSlash == std::string::npos ? "./" : SourcePath.substr(0, LastSlash + 1);
+
+    std::vector<ImportRequest> Frontier = scanImports(Lexer(std::string_view((*Buffer)->getBufferStart(), (*Buffer)->getBufferSize())));
+    std::unordered_set<SymbolID> Seen;
+    while (!Frontier.empty()) {
+        ImportRequest R = Frontier.back();
+        Frontier.pop_back();
+        if (!Seen.insert(R.Module).second) continue;
+        if (std::shared_ptr<ModuleFile> File = loadModuleFile(symbolName(R.Module) + ".qnt"))
+            Frontier.insert(Frontier.end(), File->Imports.begin(), File->Imports.end());
+    }
+    RootDir = SavedRootDir;
+}
 
-    // 6. Parse the Library file
-   // 6. Parse the Library
+// Skips a balanced { ... } without building any AST
+void Parser::skipBlock() {
+    // The body is lexed again when it is parsed; stop before the token
+    // after the closing '}', which belongs to the caller.
+    Window.Lex->setQuiet(true);
+    int Depth = 0;
     while (getTok().type != TOK_EOF) {
-        if (getTok().type == TOK_IMPORT) {
-            parseImport(); 
+        int t = getTok().type;
+        advance();
+        if (t == '{') Depth++;
+        else if (t == '}' && --Depth <= 0) break;
+    }
+    Window.Lex->setQuiet(false);
+}
+
+// Parses a function's signature (registering it) and skips its body, which
+// is recorded in D for parseBodies(). D.SourceEnd is the caller's to fill in.
+bool Parser::deferFunction(DeferredBody &D) {
+    D.Module = CurrentModule;
+    std::vector<SymbolID> *Saved = CallSink;
+    CallSink = &D.Callees;
+    D.Fn = parseFunctionSignature();
+    CallSink = Saved;
+    if (!D.Fn) return false;
+
+    if (getTok().type != '{') {
+        LogError("Expected '{' to start function body");
+        return false;
+    }
+    D.BodyStart = getTok();
+    skipBlock();
+    return true;
+}
+
+// Worker body: scan every function signature of one module. Bodies are
+// skipped; parseReachableBodies() comes back for the ones the program uses.
+static void parseModuleUnit(ModuleUnit &M) {
+    std::ostringstream Diag;
+    Lexer ModuleLexer(std::string_view(M.Source->getBufferStart(), M.Source->getBufferSize()));
+    Parser P(ModuleLexer, *M.Arena, &Diag, &M);
+
+    while (P.getTok().type != TOK_EOF) {
+        if (P.getTok().type == TOK_IMPORT) {
+            P.parseImport(); 
         } 
-        else if (isFunctionDefinition()) {
-            if (auto Fn = parseFunction()) {
-                std::string Name = Fn->getName();
-
-                // --- SELECTIVE IMPORT FILTER ---
-                // If we asked for a specific function (e.g., "add")
-                // AND this function is NOT "add"...
-                if (!SpecificFunc.empty() && Name != SpecificFunc) {
-                    // 1. Don't generate code for it (skip Hook)
-                    // 2. Remove it from the Registry so the parser doesn't think it exists
-                    FunctionRegistry.erase(Name); 
-                } 
-                else {
-                    // It matches (or we are importing everything). Keep it!
-                    ImportedFunctionsHook.push_back(std::move(Fn));
-                }
-            }
+        else if (P.isFunctionDefinition()) {
+            LazyFunction LF;
+            LF.SourceEnd = M.Source->getBufferEnd();
+            if (P.deferFunction(LF)) M.Functions.push_back(std::move(LF));
         } 
         else {
-            advance(); 
+            P.advance(); 
         }
     }
+    M.Diagnostics = Diag.str();
+}
+
+// Publish a scanned module: only the signatures its importers asked for
+// become visible to them.
+static void mergeModuleUnit(ModuleUnit &M) {
+    info() << "[Quanta] Importing " << M.Filename << "..." << std::endl;
+    diag() << M.Diagnostics;
+
+    for (auto &LF : M.Functions) {
+        SymbolID Name = LF.Fn->getName();
+        M.Lazy.emplace(Name, &LF);
+        if (!M.ImportAll && !M.Wanted.count(Name)) continue; // Selective import
+        FunctionRegistry[Name] = M.Registry[Name];
+    }
+    LoadedModules.insert(M.Name);
+    M.Done = true;
+}
+
+static void resolveImports(const std::vector<ImportRequest> &RootImports) {
+    std::vector<std::unique_ptr<ModuleUnit>> &Units = ImportedUnits;
+    std::unordered_map<SymbolID, ModuleUnit*> Seen;
+
+    // 1. Discover the graph breadth-first; each level is read and scanned in parallel
+    std::vector<ImportRequest> Frontier = RootImports;
+    while (!Frontier.empty()) {
+        std::vector<ModuleUnit*> Fresh;
+        for (const ImportRequest &R : Frontier) {
+            if (LoadedModules.count(R.Module)) continue;
+            ModuleUnit *&M = Seen[R.Module];
+            if (!M) {
+                Units.push_back(std::make_unique<ModuleUnit>());
+                M = Units.back().get();
+                M->Name = R.Module;
+                M->Filename = symbolName(R.Module) + ".qnt";
+                Fresh.push_back(M);
+            }
+            if (R.Func == SYM_NONE) M->ImportAll = true;
+            else M->Wanted.insert(R.Func);
+        }
 
-    // 7. Restore Context back to the original file
-    globalTokens = OldTokens;
-    currentToken = OldPos;
+        llvm::parallelFor(0, Fresh.size(), [&](size_t I) {
+            ModuleUnit &M = *Fresh[I];
+            if (std::shared_ptr<ModuleFile> File = loadModuleFile(M.Filename)) {
+                M.Source = std::shared_ptr<llvm::MemoryBuffer>(File, File->Buffer.get());
+                M.Imports = File->Imports;
+            }
+        });
 
-    // 8. FINAL VERIFICATION: Did the file actually contain the specific function?
-    if (!SpecificFunc.empty()) {
-        if (FunctionRegistry.find(SpecificFunc) == FunctionRegistry.end()) {
-             LogError(("Import Error: Function '" + SpecificFunc + "' not found in module '" + ModuleName + "'").c_str());
+        Frontier.clear();
+        for (ModuleUnit *M : Fresh) {
+            if (!M->Source) continue; // Reported by parseImport()
+            ImportGraph[M->Name] = M;
+            Frontier.insert(Frontier.end(), M->Imports.begin(), M->Imports.end());
         }
     }
+
+    // 2. Parse in waves: a module is ready once everything it imports is merged
+    std::vector<ModuleUnit*> Pending;
+    for (auto &M : Units)
+        if (M->Source) Pending.push_back(M.get());
+
+    while (!Pending.empty()) {
+        std::vector<ModuleUnit*> Wave, Rest;
+        for (ModuleUnit *M : Pending) {
+            bool Ready = true;
+            for (const ImportRequest &R : M->Imports) {
+                auto It = ImportGraph.find(R.Module);
+                if (It != ImportGraph.end() && It->second != M && !It->second->Done) Ready = false;
+            }
+            (Ready ? Wave : Rest).push_back(M);
+        }
+        // Import cycle: nothing is ready, so parse what is left together
+        if (Wave.empty()) Wave.swap(Rest);
+
+        llvm::parallelFor(0, Wave.size(), [&](size_t I) { parseModuleUnit(*Wave[I]); });
+
+        // 3. Merge in discovery order, not completion order
+        for (ModuleUnit *M : Wave) mergeModuleUnit(*M);
+        Pending.swap(Rest);
+    }
+
+    ImportGraph.clear();
+}
+
+// --- DEFERRED BODIES ---
+// Bodies are re-lexed from their '{' (keeping line numbers) by a Parser of
+// their own, so any number of them can be parsed at once.
+static void parseBody(DeferredBody &D, ASTArena &Arena) {
+    std::string_view Rest(D.BodyStart.value.data(), D.SourceEnd - D.BodyStart.value.data());
+    Lexer BodyLexer(Rest, D.BodyStart.line);
+    std::ostringstream Diag;
+    {
+        Parser P(BodyLexer, Arena, &Diag, D.Module);
+        P.setCallSink(&D.Callees);
+        P.setVisibleFunctions(D.Ordinal);
+        D.Fn->Body = P.parseBlock();
+    }
+    D.Diagnostics = Diag.str();
+}
+
+// Parses the bodies on the LLVM thread pool in contiguous batches, each
+// into a fresh arena appended to Arenas. Diagnostics stay in each body for
+// the caller to replay in order.
+static void parseBodies(const std::vector<DeferredBody*> &Bodies,
+                        std::vector<std::unique_ptr<ASTArena>> &Arenas) {
+    if (Bodies.empty()) return;
+    size_t Batches = std::min<size_t>(Bodies.size(), 4 * llvm::parallel::strategy.compute_thread_count());
+    size_t First = Arenas.size();
+    for (size_t I = 0; I < Batches; I++) Arenas.push_back(std::make_unique<ASTArena>());
+
+    llvm::parallelFor(0, Batches, [&](size_t B) {
+        size_t Begin = Bodies.size() * B / Batches, End = Bodies.size() * (B + 1) / Batches;
+        for (size_t I = Begin; I < End; I++) parseBody(*Bodies[I], *Arenas[First + B]);
+    });
 }
-std::unique_ptr<ASTNode> parseLoop() {
+
+// The imported function a call to Name from module From (null for the main
+// file) lands on: the caller's own module first, then any imported one. The
+// main file's own functions are never imported.
+static LazyFunction *findImported(SymbolID Name, ModuleUnit *From,
+                                  const std::unordered_map<SymbolID, LazyFunction*> &ByName) {
+    if (From) {
+        auto Own = From->Lazy.find(Name);
+        if (Own != From->Lazy.end()) return Own->second;
+    } else if (MainFileOrder.count(Name)) {
+        return nullptr;
+    }
+    auto It = ByName.find(Name);
+    return It == ByName.end() ? nullptr : It->second;
+}
+
+// Callees before callers, so codegen always finds the function it calls
+static void emitCalleesFirst(LazyFunction &LF, std::unordered_map<SymbolID, LazyFunction*> &ByName) {
+    if (LF.Emitted) return;
+    LF.Emitted = true;
+    for (SymbolID Callee : LF.Callees) {
+        LazyFunction *Target = findImported(Callee, LF.Module, ByName);
+        if (Target && Target->Queued) emitCalleesFirst(*Target, ByName);
+    }
+    SymbolID Name = LF.Fn->getName();
+    FunctionRegistry.emplace(Name, LF.Module->Registry[Name]); // Helpers nobody imported by name
+    ImportedFunctionsHook.push_back(LF.Fn);
+}
+
+// Parse the bodies of the imported functions the program can actually reach,
+// starting from the calls made by the importing file. Each round's bodies are
+// parsed in parallel; their calls feed the next round.
+static void parseReachableBodies(const std::vector<SymbolID> &RootCalls,
+                                 std::vector<std::unique_ptr<ASTArena>> &Arenas) {
+    std::unordered_map<SymbolID, LazyFunction*> ByName;
+    for (auto &M : ImportedUnits)
+        for (auto &LF : M->Functions) ByName.emplace(LF.Fn->getName(), &LF);
+
+    std::vector<LazyFunction*> Round, Reached;
+    auto demand = [&](SymbolID Name, ModuleUnit *From) {
+        LazyFunction *LF = findImported(Name, From, ByName);
+        if (!LF || LF->Queued) return;
+        LF->Queued = true;
+        Round.push_back(LF);
+    };
+    for (SymbolID Name : RootCalls) demand(Name, nullptr);
+
+    while (!Round.empty()) {
+        std::vector<LazyFunction*> Batch;
+        Batch.swap(Round);
+        parseBodies(std::vector<DeferredBody*>(Batch.begin(), Batch.end()), Arenas);
+        for (LazyFunction *LF : Batch) {
+            diag() << LF->Diagnostics;
+            for (SymbolID Callee : LF->Callees) demand(Callee, LF->Module);
+            Reached.push_back(LF);
+        }
+    }
+
+    for (LazyFunction *LF : Reached) emitCalleesFirst(*LF, ByName);
+}
+
+ASTNode *Parser::parseLoop() {
     advance(); // Eat 'loop'
 
     // loop i in string { body } -- index loop over string
     if (getTok().type == TOK_IDENTIFIER) {
-        std::string varName = getTok().value;
+        SymbolID varName = intern(getTok().value);
         advance();
         if (getTok().type != TOK_IN) return LogError("Expected 'in' after loop variable");
         advance();
         auto strExpr = parseExpression();
         if (!strExpr) return nullptr;
-        if (getTok().value != "{") return LogError("Expected '{' to start loop body");
+        if (getTok().type != '{') return LogError("Expected '{' to start loop body");
         auto bodyStmts = parseBlock();
-        auto Body = std::make_unique<BlockAST>(std::move(bodyStmts));
-        return std::make_unique<LoopOverStringAST>(varName, std::move(strExpr), std::move(Body));
+        auto Body = makeNode<BlockAST>(std::move(bodyStmts));
+        return makeNode<LoopOverStringAST>(varName, strExpr, Body);
     }
 
-    if (getTok().value != "(") return LogError("Expected '(' after loop or 'id in expr'");
+    if (getTok().type != '(') return LogError("Expected '(' after loop or 'id in expr'");
     advance(); 
 
     auto Cond = parseExpression();
     if (!Cond) return nullptr;
 
-    if (getTok().value != ")") return LogError("Expected ')' after loop condition");
+    if (getTok().type != ')') return LogError("Expected ')' after loop condition");
     advance(); 
 
-    if (getTok().value != "{") return LogError("Expected '{' to start loop body");
+    if (getTok().type != '{') return LogError("Expected '{' to start loop body");
     
     auto bodyStmts = parseBlock();
-    auto Body = std::make_unique<BlockAST>(std::move(bodyStmts));
+    auto Body = makeNode<BlockAST>(std::move(bodyStmts));
 
-    return std::make_unique<LoopAST>(std::move(Cond), std::move(Body));
+    return makeNode<LoopAST>(Cond, Body);
 }
 
-std::unique_ptr<ASTNode> parseExpression();
 // --- 1. PRIMARY PARSER ---
-std::unique_ptr<ASTNode> parsePrimary() {
-    Token t = getTok();
+ASTNode *Parser::parsePrimary() {
+    // Only read before the first advance(); later advances may recycle the slot.
+    const Token &t = getTok();
 
     // --- 1. STRINGS ---
     if (t.type == TOK_STRING) {
-        std::string strVal = t.value; 
+        std::string strVal(t.value); 
         advance();                    
-        return std::make_unique<StringAST>(strVal);
+        return makeNode<StringAST>(strVal);
     }
 
     // --- 2. NUMBERS ---
     if (t.type == TOK_NUMBER) {
         errno = 0;
         char* endPtr;
-        int64_t val = std::strtoll(t.value.c_str(), &endPtr, 10);
+        int64_t val = std::strtoll(std::string(t.value).c_str(), &endPtr, 10);
         
         if (errno == ERANGE) {
-            std::cerr << "[Quanta Error] Number literal too large, defaulting to 0.\n";
+            diag() << "[Quanta Error] Number literal too large, defaulting to 0.\n";
             val = 0;
         }
         
         advance(); 
-        return std::make_unique<NumberAST>(val);
+        return makeNode<NumberAST>(val);
     }
 
     // --- 3. FLOATS ---
     if (t.type == TOK_FLOAT) {
-        double dVal = std::stod(t.value); 
+        double dVal = std::stod(std::string(t.value)); 
         advance();                        
-        return std::make_unique<FloatAST>(dVal);
+        return makeNode<FloatAST>(dVal);
     }
 
     // --- 4. CHARS ---
     if (t.type == TOK_CHAR) {
         char cVal = t.value[0]; 
         advance();              
-        return std::make_unique<CharAST>(cVal);
+        return makeNode<CharAST>(cVal);
     }
 
     // --- 5. BOOLEANS ---
     if (t.type == TOK_TRUE) {
         advance();
-        return std::make_unique<BoolAST>(true);
+        return makeNode<BoolAST>(true);
     }
     if (t.type == TOK_FALSE) {
         advance();
-        return std::make_unique<BoolAST>(false);
+        return makeNode<BoolAST>(false);
     }
 
     // --- 6. PARENTHESES (Expression) ---
-    if (t.value == "(") {
+    if (t.type == '(') {
         advance();
         auto expr = parseExpression();
         if (!expr) return nullptr;
-        if (getTok().value != ")") return LogError("Expected ')' after expression");
+        if (getTok().type != ')') return LogError("Expected ')' after expression");
         advance();
         return expr;
     }
 
     // --- 6.5 ARRAYS / LISTS [a, b, c] ---
-    if (t.value == "[") {
+    if (t.type == '[') {
         advance(); // Eat '['
-        std::vector<std::unique_ptr<ASTNode>> Elements;
-        if (getTok().value != "]") {
+        std::vector<ASTNode*> Elements;
+        if (getTok().type != ']') {
             while (true) {
                 auto arg = parseExpression();
                 if (!arg) return nullptr;
-                Elements.push_back(std::move(arg));
-                if (getTok().value == "]") break;
-                if (getTok().value != ",") return LogError("Expected ',' or ']' in array literal");
+                Elements.push_back(arg);
+                if (getTok().type == ']') break;
+                if (getTok().type != ',') return LogError("Expected ',' or ']' in array literal");
                 advance(); // Eat ','
             }
         }
         advance(); // Eat ']'
-        return std::make_unique<ArrayExprAST>(std::move(Elements));
+        return makeNode<ArrayExprAST>(std::move(Elements));
     }
 
     // --- 7. LOOPS ---
@@ -348,26 +806,26 @@ std::unique_ptr<ASTNode> parsePrimary() {
     // --- 8. TYPE / BYTESIZE ---
     if (t.value == "type") {
         advance(); 
-        if (getTok().value != "(") return LogError("Expected '(' after type");
+        if (getTok().type != '(') return LogError("Expected '(' after type");
         advance(); 
         if (getTok().type != TOK_IDENTIFIER) return LogError("Expected variable name inside type(...)");
-        std::string varName = getTok().value;
+        SymbolID varName = intern(getTok().value);
         advance(); 
-        if (getTok().value != ")") return LogError("Expected ')' after variable name");
+        if (getTok().type != ')') return LogError("Expected ')' after variable name");
         advance(); 
-        return std::make_unique<TypeofAST>(varName);
+        return makeNode<TypeofAST>(varName);
     }
 
     if (t.value == "bytesize") {
         advance(); 
-        if (getTok().value != "(") return LogError("Expected '(' after bytesize");
+        if (getTok().type != '(') return LogError("Expected '(' after bytesize");
         advance(); 
         if (getTok().type != TOK_IDENTIFIER) return LogError("Expected variable name inside bytesize(...)");
-        std::string varName = getTok().value;
+        SymbolID varName = intern(getTok().value);
         advance(); 
-        if (getTok().value != ")") return LogError("Expected ')' after variable name");
+        if (getTok().type != ')') return LogError("Expected ')' after variable name");
         advance(); 
-        return std::make_unique<ByteSizeAST>(varName);
+        return makeNode<ByteSizeAST>(varName);
     }
 
     
@@ -378,19 +836,18 @@ std::unique_ptr<ASTNode> parsePrimary() {
  if (t.type == TOK_IDENTIFIER) {
         // [CRITICAL] 1. Define IdName FIRST
         // --- Inside your variable declaration parsing logic ---
-        std::string IdName = t.value; 
+        SymbolID IdName = intern(t.value); 
         advance(); // Eat Identifier Token
 
         // --- 2. MODULE LOGIC (test.getArea) ---
         // We evaluate if it's a module. If it's an object property access (.push()), we drop down and let Postfix handle it.
         if (getTok().type == TOK_DOT) {
-            std::string ModuleName = IdName;
-            std::string ExpectedFile = ModuleName + ".qnt";
-            if (LoadedModules.find(ExpectedFile) != LoadedModules.end()) {
+            SymbolID ModuleName = IdName;
+            if (LoadedModules.count(ModuleName)) {
                 advance(); // Eat '.'
-                std::string FuncName = getTok().value;
-                if (FunctionRegistry.find(FuncName) == FunctionRegistry.end()) {
-                     return LogError(("Error: Function '" + FuncName + "' is not defined in module '" + ModuleName + "'.").c_str());
+                SymbolID FuncName = intern(getTok().value);
+                if (!isKnownFunction(FuncName)) {
+                     return LogError(("Error: Function '" + symbolName(FuncName) + "' is not defined in module '" + symbolName(ModuleName) + "'.").c_str());
                 }
                 IdName = FuncName; // Update to function name
                 advance(); // Eat function name
@@ -398,16 +855,16 @@ std::unique_ptr<ASTNode> parsePrimary() {
         }
 
         // --- 3. FUNCTION CALL LOGIC (identifier(...)) ---
-        if (getTok().value == "(") {
+        if (getTok().type == '(') {
             
             // [NEW] GLOBAL VALIDATION CHECK
             // We check if the function exists in the Registry.
             // We skip built-in functions like "print" or "input".
-            if (IdName != "print" && IdName != "input" && IdName != "delay" && 
-                IdName != "type" && IdName != "bytesize") {
+            if (IdName != SYM_PRINT && IdName != SYM_INPUT && IdName != SYM_DELAY && 
+                IdName != SYM_TYPE && IdName != SYM_BYTESIZE) {
                 
-                if (FunctionRegistry.find(IdName) == FunctionRegistry.end()) {
-                    return LogError(("Error: Function '" + IdName + "' is not defined. Did you mean to import it?").c_str());
+                if (!isKnownFunction(IdName)) {
+                    return LogError(("Error: Function '" + symbolName(IdName) + "' is not defined. Did you mean to import it?").c_str());
                 }
             }
             // ------------------------------------------------
@@ -416,88 +873,83 @@ std::unique_ptr<ASTNode> parsePrimary() {
             
             std::vector<CallArg> args; 
 
-            if (getTok().value != ")") {
+            if (getTok().type != ')') {
                 while (true) {
-                    std::string argName = "";
-                    std::shared_ptr<ASTNode> argVal = nullptr;
-
-                    // Keyword Argument Detection
-                    if (getTok().type == TOK_IDENTIFIER) {
-                        std::string tempName = getTok().value; 
-                        advance(); 
-                        
-                        if (getTok().value == "=") {
-                            advance(); // Eat '='
-                            argName = tempName;          
-                            argVal = parseExpression(); 
-                        } 
-                        else {
-                            // Backtrack: It was just a variable like 'x'
-                            auto lhs = std::make_unique<VariableAST>(tempName);
-                            argVal = parseBinOpRHS(0, std::move(lhs));
-                        }
-                    } 
-                    else {
-                        argVal = parseExpression();
+                    SymbolID argName = SYM_NONE;
+                    ASTNode *argVal = nullptr;
+
+                    // Keyword Argument Detection (name '=' ...)
+                    if (getTok().type == TOK_IDENTIFIER && peekTok(1).type == '=') {
+                        argName = intern(getTok().value);
+                        advance(); // Eat name
+                        advance(); // Eat '='
                     }
+                    argVal = parseExpression();
 
                     if (!argVal) return nullptr;
-                    args.push_back({argName, std::move(argVal)});
+                    args.push_back({argName, argVal});
 
-                    if (getTok().value == ")") break;
-                    if (getTok().value != ",") return LogError("Expected ')' or ','");
+                    if (getTok().type == ')') break;
+                    if (getTok().type != ',') return LogError("Expected ')' or ','");
                     advance(); // Eat ','
                 }
             }
             advance(); // Eat ')'
-            return std::make_unique<CallAST>(IdName, std::move(args));
+            if (CallSink) CallSink->push_back(IdName);
+            return makeNode<CallAST>(IdName, std::move(args));
         }
 
         // --- 4. ASSIGNMENT LOGIC (identifier = ...) ---
-        if (getTok().value == "=") {
+        if (getTok().type == '=') {
             advance(); // Eat '='
             if (auto RHS = parseExpression())
-                return std::make_unique<AssignmentAST>(IdName, std::move(RHS));
+                return makeNode<AssignmentAST>(IdName, RHS);
             return nullptr;
         }
 
         // --- 5. VARIABLE USAGE (identifier) ---
-        return std::make_unique<VariableAST>(IdName);
+        return makeNode<VariableAST>(IdName);
     }
     
     
     
-    return LogError("Unexpected token '" + t.value + "'");
+    return LogError("Unexpected token '" + std::string(t.value) + "'");
 }
 
 
-bool isFunctionDefinition() {
-    int savePos = currentToken; // Save current position
-    
+// "type name(" starts a function definition. Peek(N) is the type of the
+// token N ahead; shared with splitTopLevel(), which works on raw tokens.
+template <typename PeekFn>
+static bool startsFunctionDefinition(PeekFn Peek) {
+    // 0. An optional 'const'
+    unsigned At = Peek(0) == TOK_CONST ? 1 : 0;
+
     // 1. Check for Type
-    int t = getTok().type;
+    int t = Peek(At);
     bool hasType = (t == TOK_INT || t == TOK_VOID || t == TOK_FLOAT || 
                     t == TOK_STRING || t == TOK_BOOL);
     
     if (!hasType) return false; 
-    advance(); // Eat type
 
     // 2. Check for Name
-    if (getTok().type != TOK_IDENTIFIER) {
-        currentToken = savePos; 
-        return false;
-    }
-    advance(); // Eat name
+    if (Peek(At + 1) != TOK_IDENTIFIER) return false;
 
     // 3. Check for '('
-    bool isFunc = (getTok().value == "(");
-    
-    currentToken = savePos; // Reset position
-    return isFunc;
+    return Peek(At + 2) == '(';
+}
+
+bool Parser::isFunctionDefinition() {
+    return startsFunctionDefinition([this](unsigned N) { return peekTok(N).type; });
 }
 
 
-std::unique_ptr<FunctionAST> parseFunction() {
+// Parses "type name(args)" and registers the function. The body is left
+// empty: deferFunction() skips it and parseBody() fills it in later.
+FunctionAST *Parser::parseFunctionSignature() {
+    // 0. 'const': calls with literal arguments are evaluated while compiling
+    bool isConst = getTok().type == TOK_CONST;
+    if (isConst) advance();
+
     // 1. Parse Return Type
     std::string returnType = "void"; 
     if (getTok().type == TOK_INT || getTok().type == TOK_INT8 || 
@@ -513,11 +965,11 @@ std::unique_ptr<FunctionAST> parseFunction() {
         return nullptr;                      // <--- CHANGED
     }
     
-    std::string name = getTok().value;
+    SymbolID name = intern(getTok().value);
     advance();
 
     // 3. Parse Arguments: "("
-    if (getTok().value != "(") {
+    if (getTok().type != '(') {
         LogError("Expected '(' after function name"); // <--- CHANGED
         return nullptr;                               // <--- CHANGED
     }
@@ -526,12 +978,12 @@ std::unique_ptr<FunctionAST> parseFunction() {
     std::vector<FuncArg> astArgs;      
     std::vector<ArgInfo> registryArgs; 
 
-    if (getTok().value != ")") {
+    if (getTok().type != ')') {
         while (true) {
             std::string argType = "int"; // Default to int if unknown
             bool typeSpecified = false;  
-            std::string argName = "";
-            std::shared_ptr<ASTNode> defaultVal = nullptr;
+            SymbolID argName = SYM_NONE;
+            ASTNode *defaultVal = nullptr;
 
             // 1. Check for Explicit Type (e.g., "string name")
             if (getTok().value == "int" || getTok().value == "int8" || 
@@ -546,11 +998,11 @@ std::unique_ptr<FunctionAST> parseFunction() {
                 LogError("Expected argument name.");
                 return nullptr;
             }
-            argName = getTok().value;
+            argName = intern(getTok().value);
             advance(); 
 
             // 3. Parse Default Value & INFER TYPE
-            if (getTok().value == "=") {
+            if (getTok().type == '=') {
                 advance(); 
                 defaultVal = parseExpression(); 
                 if (!defaultVal) return nullptr;
@@ -559,7 +1011,7 @@ std::unique_ptr<FunctionAST> parseFunction() {
                 if (!typeSpecified) {
                     // Check if default value is a String Literal
                     // FIX: Use 'StringAST' (your class name) instead of 'StringExprAST'
-                    if (dynamic_cast<StringAST*>(defaultVal.get())) {
+                    if (llvm::isa<StringAST>(defaultVal)) {
                         argType = "string";
                     }
                     // Optional: Check for floats vs ints here if needed
@@ -570,9 +1022,9 @@ std::unique_ptr<FunctionAST> parseFunction() {
             astArgs.push_back({argType, argName});
             registryArgs.push_back({argName, argType, defaultVal});
 
-            if (getTok().value == ")") break;
+            if (getTok().type == ')') break;
             
-            if (getTok().value != ",") {
+            if (getTok().type != ',') {
                 LogError("Expected ',' or ')' in argument list");
                 return nullptr;
             }
@@ -582,29 +1034,24 @@ std::unique_ptr<FunctionAST> parseFunction() {
     }
     advance(); 
 
-    FunctionRegistry[name] = {name, registryArgs};
-
-    // 5. Parse Body
-    if (getTok().value != "{") {
-        LogError("Expected '{' to start function body"); // <--- CHANGED
-        return nullptr;                                  // <--- CHANGED
-    }
-    
-    auto body = parseBlock(); 
-
-    return std::make_unique<FunctionAST>(
+    FunctionAST *fn = makeNode<FunctionAST>(
         returnType, 
         name, 
         std::move(astArgs), 
-        std::move(body)
+        std::vector<ASTNode*>()
     );
+    fn->IsConst = isConst;
+    registerFunction(name, std::move(registryArgs), fn);
+    return fn;
 }
 
 
 // --- HELPER 2: Parse a Single Statement ---
 // Unifies logic for Blocks and Top-Level Scripts
-std::unique_ptr<ASTNode> parseStatement() {
+ASTNode *Parser::parseStatement() {
     int t = getTok().type;
+    // A float literal ("3.5") is a TOK_FLOAT too, but starts an expression
+    if (t == TOK_FLOAT && isdigit((unsigned char)getTok().value[0])) t = TOK_NUMBER;
 
     if (t == TOK_INT || t == TOK_FLOAT || t == TOK_BOOL || 
         t == TOK_STRING || t == TOK_VAR) {
@@ -620,23 +1067,23 @@ std::unique_ptr<ASTNode> parseStatement() {
     int line = getTok().line;
         advance(); // Eat 'return'
         
-        std::unique_ptr<ASTNode> expr = nullptr;
+        ASTNode *expr = nullptr;
         
         // 1. Parse the return value (if it exists)
-        if (getTok().value != ";") {
+        if (getTok().type != ';') {
             expr = parseExpression();
             if (!expr) return nullptr; // Safety check: if parsing failed, stop here
         }
 
         // 2. Consume the semicolon
-        if (getTok().value == ";") {
+        if (getTok().type == ';') {
             advance(); // Eat ';'
         } 
 
         // [CRITICAL FIX] 
         // Wrap the expression in ReturnAST. 
         // This ensures Codegen calls Builder.CreateRet() instead of just evaluating the number.
-        return std::make_unique<ReturnAST>(std::move(expr),line); 
+        return makeNode<ReturnAST>(expr,line); 
     }
     else {
         return parseExpression();
@@ -644,30 +1091,30 @@ std::unique_ptr<ASTNode> parseStatement() {
 }
 
 // --- Parse Block { ... } ---
-std::vector<std::unique_ptr<ASTNode>> parseBlock() {
-    if (getTok().value != "{") {
+std::vector<ASTNode*> Parser::parseBlock() {
+    if (getTok().type != '{') {
         LogError("Expected '{' to start block");
         return {};
     }
     advance(); // Eat '{'
 
-    std::vector<std::unique_ptr<ASTNode>> stmts;
+    std::vector<ASTNode*> stmts;
 
-    while (getTok().type != TOK_EOF && getTok().value != "}") {
+    while (getTok().type != TOK_EOF && getTok().type != '}') {
         auto stmt = parseStatement(); // Use the new helper
         if (stmt) {
-            stmts.push_back(std::move(stmt));
-            if (getTok().value == ";") advance(); // Eat optional ';'
+            stmts.push_back(stmt);
+            if (getTok().type == ';') advance(); // Eat optional ';'
         } else {
             synchronize();
         }
     }
 
-    if (getTok().value == "}") advance(); // Eat '}'
+    if (getTok().type == '}') advance(); // Eat '}'
     return stmts;
 }
 // --- Parse If / Elif / Else ---
-std::unique_ptr<ASTNode> parseIfExpr() {
+ASTNode *Parser::parseIfExpr() {
     advance(); // Eat 'if'
 
     // 1. Condition
@@ -675,14 +1122,14 @@ std::unique_ptr<ASTNode> parseIfExpr() {
     if (!Cond) return nullptr;
 
     // 2. Then Block
-    if (getTok().value != "{") return LogError("Expected '{' after if condition");
+    if (getTok().type != '{') return LogError("Expected '{' after if condition");
     
     // [FIX] Wrap the vector in BlockAST
     auto thenStmts = parseBlock(); 
-    auto Then = std::make_unique<BlockAST>(std::move(thenStmts));
+    auto Then = makeNode<BlockAST>(std::move(thenStmts));
 
     // 3. Else / Elif Logic
-    std::unique_ptr<ASTNode> Else = nullptr;
+    ASTNode *Else = nullptr;
     
     if (getTok().type == TOK_ELIF) {
         Else = parseIfExpr(); // Recursively parse 'elif'
@@ -693,18 +1140,18 @@ std::unique_ptr<ASTNode> parseIfExpr() {
         if (getTok().type == TOK_IF) {
             Else = parseIfExpr(); // "else if"
         } else {
-            if (getTok().value != "{") return LogError("Expected '{' after else");
+            if (getTok().type != '{') return LogError("Expected '{' after else");
             
             // [FIX] Wrap the else block vector in BlockAST
             auto elseStmts = parseBlock();
-            Else = std::make_unique<BlockAST>(std::move(elseStmts));
+            Else = makeNode<BlockAST>(std::move(elseStmts));
         }
     }
 
-    return std::make_unique<IfExprAST>(std::move(Cond), std::move(Then), std::move(Else));
+    return makeNode<IfExprAST>(Cond, Then, Else);
 }
 
-std::unique_ptr<ASTNode> parseVarDecl() {
+ASTNode *Parser::parseVarDecl() {
     Token typeTok = getTok();
     advance(); 
 
@@ -715,20 +1162,20 @@ std::unique_ptr<ASTNode> parseVarDecl() {
     bool isFixedString = false;
     
     // Check if the very next token is "["
-    if (getTok().value == "[") {
+    if (getTok().type == '[') {
         advance(); // Eat '['
-        if (getTok().value == "]") {
+        if (getTok().type == ']') {
             isDynamicList = true;
             advance(); // Eat ']'
         } else if (getTok().type == TOK_NUMBER) {
-            capacity = std::stoi(getTok().value);
+            capacity = std::stoi(std::string(getTok().value));
             if (typeTok.type == TOK_STRING) {
                 isFixedString = true;
             } else {
                 isFixedArray = true;
             }
             advance(); // Eat the number
-            if (getTok().value != "]") return LogError("Expected ']' after capacity");
+            if (getTok().type != ']') return LogError("Expected ']' after capacity");
             advance(); // Eat ']'
         } else {
             return LogError("Expected number or ']' after '[' in type declaration");
@@ -738,11 +1185,11 @@ std::unique_ptr<ASTNode> parseVarDecl() {
     
     // 1. Expect Name
     if (getTok().type != TOK_IDENTIFIER) return LogError("Expected variable name");
-    std::string name = getTok().value;
+    SymbolID name = intern(getTok().value);
     advance(); // Eat Name
 
     // 2. Expect '='
-    if (getTok().value != "=") return LogError("Expected '=' in declaration");
+    if (getTok().type != '=') return LogError("Expected '=' in declaration");
     advance(); // Eat '='
 
     // 3. Parse Value
@@ -751,24 +1198,24 @@ std::unique_ptr<ASTNode> parseVarDecl() {
 
     // 4. DETERMINE TYPE & SIZE
     // We calculate this AFTER parsing the value so we can support 'var'
-    std::string typeStr = typeTok.value;
+    std::string typeStr(typeTok.value);
     int bytes = 4; // Default
 
     // CASE A: Auto-Detect (var)
     if (typeTok.type == TOK_VAR) {
-        if (dynamic_cast<StringAST*>(init.get())) {
+        if (llvm::isa_and_nonnull<StringAST>(init)) {
             typeStr = "string";
             bytes = 8;
         }
-        else if (dynamic_cast<FloatAST*>(init.get())) {
+        else if (llvm::isa_and_nonnull<FloatAST>(init)) {
             typeStr = "float";
             bytes = 8;
         }
-        else if (dynamic_cast<BoolAST*>(init.get())) {
+        else if (llvm::isa_and_nonnull<BoolAST>(init)) {
             typeStr = "bool";
             bytes = 1;
         }
-        else if (dynamic_cast<CharAST*>(init.get())) {
+        else if (llvm::isa_and_nonnull<CharAST>(init)) {
             typeStr = "char";
             bytes = 1;
         }
@@ -791,7 +1238,7 @@ std::unique_ptr<ASTNode> parseVarDecl() {
             bytes = 4;
         } else {
             // Get the number part (e.g., "int9" -> "9")
-            std::string numStr = typeTok.value.substr(3);
+            std::string numStr(typeTok.value.substr(3));
             
             // USE std::atoi INSTEAD OF std::stoi (No exceptions!)
             bytes = std::atoi(numStr.c_str());
@@ -813,7 +1260,7 @@ std::unique_ptr<ASTNode> parseVarDecl() {
         } else {
             // Handle custom sizes like "float8", "float5"
             // "float" is 5 letters, so substring starts at index 5
-            std::string numStr = typeTok.value.substr(5); 
+            std::string numStr(typeTok.value.substr(5)); 
             bytes = std::atoi(numStr.c_str());
 
             // 1. Safety Check: Garbage input
@@ -833,18 +1280,18 @@ std::unique_ptr<ASTNode> parseVarDecl() {
     }
 
     if (isFixedString) {
-        return std::make_unique<FixedStringDeclAST>(name, capacity, std::move(init));
+        return makeNode<FixedStringDeclAST>(name, capacity, init);
     }
     if (isDynamicList) {
-        return std::make_unique<DynamicListDeclAST>(name, typeStr, std::move(init));
+        return makeNode<DynamicListDeclAST>(name, typeStr, init);
     }
     if (isFixedArray) {
-        return std::make_unique<FixedArrayDeclAST>(name, typeStr, capacity, std::move(init));
+        return makeNode<FixedArrayDeclAST>(name, typeStr, capacity, init);
     }
-    return std::make_unique<VarDeclAST>(name, typeStr, bytes, std::move(init));
+    return makeNode<VarDeclAST>(name, typeStr, bytes, init);
 }
 
-std::unique_ptr<ASTNode> parseBinOpRHS(int ExprPrec, std::unique_ptr<ASTNode> LHS) {
+ASTNode *Parser::parseBinOpRHS(int ExprPrec, ASTNode *LHS) {
     while (true) {
         int TokPrec = GetTokPrecedence();
 
@@ -866,67 +1313,67 @@ std::unique_ptr<ASTNode> parseBinOpRHS(int ExprPrec, std::unique_ptr<ASTNode> LH
         // the pending operator take RHS as its LHS.
         int NextPrec = GetTokPrecedence();
         if (TokPrec < NextPrec) {
-            RHS = parseBinOpRHS(TokPrec + 1, std::move(RHS));
+            RHS = parseBinOpRHS(TokPrec + 1, RHS);
             if (!RHS) return nullptr;
         }
 
         // Merge LHS/RHS. 
         // using 'int' for BinOp ensures TOK_EQ works.
-        LHS = std::make_unique<BinaryExprAST>(BinOp, std::move(LHS), std::move(RHS));
+        LHS = makeNode<BinaryExprAST>(BinOp, LHS, RHS);
     }
 }
 
 // --- 1. POSTFIX PARSER (Highest Priority: i++, s[i], s[a:b]) ---
-std::unique_ptr<ASTNode> parsePostfix() {
+ASTNode *Parser::parsePostfix() {
     auto LHS = parsePrimary();
     if (!LHS) return nullptr;
 
     // String index s[i] or slice s[start:end] or s[start:end:step]
-    while (getTok().value == "[") {
+    while (getTok().type == '[') {
         advance(); // Eat '['
         auto first = parseExpression();
         if (!first) return nullptr;
-        if (getTok().value == "]") {
+        if (getTok().type == ']') {
             advance();
             
             // --- NEW: Array/String Index Assignment arr[i] = x ---
-            if (getTok().value == "=") {
+            if (getTok().type == '=') {
                 advance(); // Eat '='
                 auto RHS = parseExpression();
                 if (!RHS) return nullptr;
-                LHS = std::make_unique<IndexAssignAST>(std::move(LHS), std::move(first), std::move(RHS));
+                LHS = makeNode<IndexAssignAST>(LHS, first, RHS);
                 continue;
             }
             
-            LHS = std::make_unique<StringIndexAST>(std::move(LHS), std::move(first));
+            LHS = makeNode<StringIndexAST>(LHS, first);
             continue;
         }
-        if (getTok().value != ":") return LogError("Expected ']' or ':' in subscript");
+        if (getTok().type != ':') return LogError("Expected ']' or ':' in subscript");
         advance();
         auto endExpr = parseExpression();
         if (!endExpr) return nullptr;
-        if (getTok().value == "]") {
+        if (getTok().type == ']') {
             advance();
-            LHS = std::make_unique<StringSliceAST>(std::move(LHS), std::move(first), std::move(endExpr), nullptr);
+            LHS = makeNode<StringSliceAST>(LHS, first, endExpr, nullptr);
             continue;
         }
-        if (getTok().value != ":") return LogError("Expected ']' or ':' after slice end");
+        if (getTok().type != ':') return LogError("Expected ']' or ':' after slice end");
         advance();
         auto stepExpr = parseExpression();
         if (!stepExpr) return nullptr;
-        if (getTok().value != "]") return LogError("Expected ']' after slice step");
+        if (getTok().type != ']') return LogError("Expected ']' after slice step");
         advance();
-        LHS = std::make_unique<StringSliceAST>(std::move(LHS), std::move(first), std::move(endExpr), std::move(stepExpr));
+        LHS = makeNode<StringSliceAST>(LHS, first, endExpr, stepExpr);
     }
 
     // Check for operator immediately after variable
     while (getTok().type == TOK_INC || getTok().type == TOK_DEC || getTok().type == TOK_DOT) {
         if (getTok().type == TOK_INC || getTok().type == TOK_DEC) {
-            auto *Var = dynamic_cast<VariableAST*>(LHS.get());
+            auto *Var = llvm::dyn_cast<VariableAST>(LHS);
             if (!Var) return LogError("Operand of ++/-- must be a variable");
             bool isInc = (getTok().type == TOK_INC);
             advance();
-            LHS = std::make_unique<UpdateExprAST>(Var->Name, isInc, false);
+            LHS = makeNode<UpdateExprAST>(Var->Name, isInc, false);
             continue;
         }
 
@@ -945,29 +1392,29 @@ std::unique_ptr<ASTNode> parsePostfix() {
                 getTok().type != TOK_ISSPACE && getTok().type != TOK_ISALNUM &&
                 getTok().type != TOK_CAPITALIZE && getTok().type != TOK_TITLE &&
                 getTok().type != TOK_LSTRIP && getTok().type != TOK_RSTRIP) {
-                return LogError(("Expected method name after '.', got: " + getTok().value).c_str());
+                return LogError(("Expected method name after '.', got: " + std::string(getTok().value)).c_str());
             }
             
-            std::string MethodName = getTok().value;
+            SymbolID MethodName = intern(getTok().value);
             advance(); // Eat method name
 
-            if (getTok().value != "(") return LogError("Expected '(' after method name");
+            if (getTok().type != '(') return LogError("Expected '(' after method name");
             advance(); // Eat '('
 
-            std::vector<std::unique_ptr<ASTNode>> args;
-            if (getTok().value != ")") {
+            std::vector<ASTNode*> args;
+            if (getTok().type != ')') {
                 while (true) {
                     auto arg = parseExpression();
                     if (!arg) return nullptr;
-                    args.push_back(std::move(arg));
-                    if (getTok().value == ")") break;
-                    if (getTok().value != ",") return LogError("Expected ',' in method args");
+                    args.push_back(arg);
+                    if (getTok().type == ')') break;
+                    if (getTok().type != ',') return LogError("Expected ',' in method args");
                     advance(); // eat ','
                 }
             }
             advance(); // Eat ')'
             
-            LHS = std::make_unique<MethodCallAST>(std::move(LHS), MethodName, std::move(args));
+            LHS = makeNode<MethodCallAST>(LHS, MethodName, std::move(args));
             continue;
         }
     }
@@ -976,13 +1423,13 @@ std::unique_ptr<ASTNode> parsePostfix() {
 }
 
 // --- 2. PREFIX PARSER (Medium Priority: ++i, unary -) ---
-std::unique_ptr<ASTNode> parseUnary() {
+ASTNode *Parser::parseUnary() {
     // Unary minus (e.g. -1, -i for negative indexing/slicing)
-    if (getTok().value == "-" && getTok().type == (int)'-') {
+    if (getTok().type == '-') {
         advance();
         auto Operand = parseUnary();
         if (!Operand) return nullptr;
-        return std::make_unique<BinaryExprAST>('-', std::make_unique<NumberAST>(0), std::move(Operand));
+        return makeNode<BinaryExprAST>('-', makeNode<NumberAST>(0), Operand);
     }
     // Check for operator BEFORE variable
     if (getTok().type == TOK_INC || getTok().type == TOK_DEC) {
@@ -992,46 +1439,46 @@ std::unique_ptr<ASTNode> parseUnary() {
         auto Operand = parseUnary(); 
         if (!Operand) return nullptr;
 
-        auto *Var = dynamic_cast<VariableAST*>(Operand.get());
+        auto *Var = llvm::dyn_cast<VariableAST>(Operand);
         if (!Var) return LogError("Operand of ++/-- must be a variable");
 
-        return std::make_unique<UpdateExprAST>(Var->Name, isInc, true);
+        return makeNode<UpdateExprAST>(Var->Name, isInc, true);
     }
     
     return parsePostfix();
 }
 
-std::unique_ptr<ASTNode> parseExpression() {
+ASTNode *Parser::parseExpression() {
     auto LHS = parseUnary();
     if (!LHS) return nullptr;
-    return parseBinOpRHS(0, std::move(LHS));
+    return parseBinOpRHS(0, LHS);
 }
-std::unique_ptr<ASTNode> parsePrint() {
+ASTNode *Parser::parsePrint() {
     advance(); // Eat 'print'
     
-    if (getTok().value != "(") {
+    if (getTok().type != '(') {
         return LogError("Expected '(' after print");
     }
     advance(); // Eat '('
 
-    std::vector<std::unique_ptr<ASTNode>> args;
+    std::vector<ASTNode*> args;
 
     // Check if there are any arguments (handle empty print())
-    if (getTok().value != ")") {
+    if (getTok().type != ')') {
         while (true) {
             // Using parseExpression() allows keywords like len() or upper()
             auto arg = parseExpression();
             if (!arg) return nullptr;
             
-            args.push_back(std::move(arg));
+            args.push_back(arg);
 
             // If we see ')', we are done with the argument list
-            if (getTok().value == ")") {
+            if (getTok().type == ')') {
                 break;
             }
 
             // If it's not a ')', it MUST be a comma to separate arguments
-            if (getTok().value != ",") {
+            if (getTok().type != ',') {
                 return LogError("Expected ',' or ')' in print arguments");
             }
             advance(); // Eat ','
@@ -1041,60 +1488,95 @@ std::unique_ptr<ASTNode> parsePrint() {
     advance(); // Eat ')'
     
     // Check for trailing semicolon (optional depending on your grammar)
-    if (getTok().value == ";") {
+    if (getTok().type == ';') {
         advance();
     }
 
-    return std::make_unique<PrintAST>(std::move(args));
+    return makeNode<PrintAST>(std::move(args));
 }
 
 
-ProgramAST parse(const std::vector<Token>& tokens) {
-    globalTokens = tokens;
-    currentToken = 0;
+// --- PARSE DRIVER ---
+// State of the parse in progress, shared by parse() and the streaming API
+static std::vector<DeferredBody> MainBodies;  // This file's functions, in order
+static std::vector<size_t> MainDiagMarks;     // End of TopLevelDiag before each body
+static std::string TopLevelDiag;
+static std::vector<SymbolID> RootCalls;       // What this file calls
+static std::vector<ASTNode*> ScriptBody;      // Buffer for script code
+
+// Step 1 of every parse: imports, then the top level of this file in order
+// (script code and function signatures). Function bodies are only
+// brace-matched into MainBodies. Diagnostics are buffered, with a mark per
+// body, so they can be replayed in source order. A REPL input keeps the
+// functions and modules of the inputs before it (KeepSession).
+static ProgramAST parseTopLevel(Lexer &lexer, bool KeepSession = false) {
     HasError = false;
+    if (!KeepSession) {
+        LoadedModules.clear();
+        FunctionRegistry.clear();
+    }
     ImportedFunctionsHook.clear();
+    MainFileOrder.clear();
+    MainBodies.clear();
+    MainDiagMarks.clear();
+    RootCalls.clear();
+    ScriptBody.clear();
+
+    // Load every imported module's signatures up front (concurrently)
+    resolveImports(scanImports(lexer));
 
     ProgramAST program;
-    std::vector<std::unique_ptr<ASTNode>> scriptBody; // Buffer for script code
+    program.Arenas.push_back(std::make_unique<ASTArena>());
+    std::ostringstream topDiag;
+    {
+        Parser P(lexer, *program.Arenas.back(), &topDiag);
+        P.setCallSink(&RootCalls);
 
-    while (getTok().type != TOK_EOF) {
+        while (P.getTok().type != TOK_EOF) {
 
-        if (getTok().type == TOK_IMPORT) {
-            parseImport();
-            continue;
-        }
+            if (P.getTok().type == TOK_IMPORT) {
+                P.parseImport();
+                continue;
+            }
         
-        // CASE A: It looks like a Function (int main() ...)
-        if (isFunctionDefinition()) {
-            auto func = parseFunction();
-            if (func) program.functions.push_back(std::move(func));
-        } 
+            // CASE A: It looks like a Function (int main() ...)
+            if (P.isFunctionDefinition()) {
+                DeferredBody body;
+                body.SourceEnd = lexer.getSource().data() + lexer.getSource().size();
+                if (P.deferFunction(body)) {
+                    body.Ordinal = MainFileOrder.size();
+                    MainFileOrder.emplace(body.Fn->getName(), body.Ordinal);
+                    program.functions.push_back(body.Fn);
+                    MainBodies.push_back(std::move(body));
+                    MainDiagMarks.push_back((size_t)topDiag.tellp());
+                }
+            } 
         
-        // CASE B: It looks like a Script Statement (print("hi");)
-        else {
-            auto stmt = parseStatement();
-            if (stmt) {
-                scriptBody.push_back(std::move(stmt));
-                if (getTok().value == ";") advance();
-            } else {
-                advance(); // Skip errors
+            // CASE B: It looks like a Script Statement (print("hi");)
+            else {
+                auto stmt = P.parseStatement();
+                if (stmt) {
+                    ScriptBody.push_back(stmt);
+                    if (P.getTok().type == ';') P.advance();
+                } else {
+                    P.advance(); // Skip errors
+                }
             }
         }
     }
+    TopLevelDiag = topDiag.str();
+    return program;
+}
 
-    for (auto& Fn : ImportedFunctionsHook) {
-        program.functions.push_back(std::move(Fn));
-    }
-    ImportedFunctionsHook.clear(); // Clean up
-    // =========================================================
-
-    // --- AUTO-MAIN LOGIC ---
+// --- AUTO-MAIN LOGIC ---
+// Returns the generated main, if there is one
+static FunctionAST *addGeneratedMain(ProgramAST &program) {
+    ASTArena &mainArena = *program.Arenas.front();
     
     // 1. Check if user wrote their own main
     bool hasExplicitMain = false;
     for (const auto& func : program.functions) {
-        if (func->getName() == "main") {
+        if (func->getName() == SYM_MAIN) {
             hasExplicitMain = true;
             break;
         }
@@ -1102,28 +1584,268 @@ ProgramAST parse(const std::vector<Token>& tokens) {
 
     // 2. Decide what to do with script code
    // 2. Wrap Script Code into 'main'
-    if (!scriptBody.empty()) {
+    if (!ScriptBody.empty()) {
         if (hasExplicitMain) {
-            std::cerr << "Error: Cannot mix top-level script code with an explicit 'main' function." << std::endl;
+            diag() << "Error: Cannot mix top-level script code with an explicit 'main' function." << std::endl;
             HasError = true;
         } else {
             // Auto-generate: void main() { ... scriptBody ... }
-            program.functions.push_back(std::make_unique<FunctionAST>(
+            return mainArena.make<FunctionAST>(
                 "void", 
-                "main", 
+                SYM_MAIN, 
                 std::vector<FuncArg>(),  // <--- CHANGED THIS
-                std::move(scriptBody)
-            ));
+                std::move(ScriptBody)
+            );
         }
     } 
     // 3. Handle Empty File (prevent linker error)
     else if (!hasExplicitMain) {
-         program.functions.push_back(std::make_unique<FunctionAST>(
-            "void", "main", 
+         return mainArena.make<FunctionAST>(
+            "void", SYM_MAIN, 
             std::vector<FuncArg>(),      // <--- CHANGED THIS
-            std::vector<std::unique_ptr<ASTNode>>()
-        ));
+            std::vector<ASTNode*>()
+        );
+    }
+    return nullptr;
+}
+
+// The program takes over the imported modules' arenas (FunctionRegistry
+// keeps pointing into them); the rest of the parse state goes.
+static void endParse(ProgramAST &program) {
+    for (auto &M : ImportedUnits) program.Arenas.push_back(std::move(M->Arena));
+    ImportedUnits.clear();
+    MainFileOrder.clear();
+    MainBodies.clear();
+    MainDiagMarks.clear();
+    RootCalls.clear();
+    ScriptBody.clear();
+}
+
+// Steps 2 and 3 of every full parse
+static void parseAllBodies(ProgramAST &program) {
+    // 2. Function bodies, concurrently
+    std::vector<DeferredBody*> pending;
+    for (DeferredBody &body : MainBodies) pending.push_back(&body);
+    parseBodies(pending, program.Arenas);
+
+    size_t shown = 0;
+    for (size_t i = 0; i < MainBodies.size(); i++) {
+        diag() << TopLevelDiag.substr(shown, MainDiagMarks[i] - shown) << MainBodies[i].Diagnostics;
+        shown = MainDiagMarks[i];
+        RootCalls.insert(RootCalls.end(), MainBodies[i].Callees.begin(), MainBodies[i].Callees.end());
     }
+    diag() << TopLevelDiag.substr(shown);
+
+    // 3. Only now parse the imported bodies this file can reach
+    parseReachableBodies(RootCalls, program.Arenas);
 
+    // Imported functions go first so their callers find them during codegen
+    program.functions.insert(program.functions.begin(),
+                             ImportedFunctionsHook.begin(), ImportedFunctionsHook.end());
+    ImportedFunctionsHook.clear(); // Clean up
+}
+
+ProgramAST parse(Lexer &lexer) {
+    ProgramAST program = parseTopLevel(lexer);
+    parseAllBodies(program);
+    if (FunctionAST *generated = addGeneratedMain(program)) program.functions.push_back(generated);
+    endParse(program);
+    return program;
+}
+
+ProgramAST parseReplInput(Lexer &lexer, SymbolID Entry) {
+    ProgramAST program = parseTopLevel(lexer, /*KeepSession=*/true);
+    parseAllBodies(program);
+    program.functions.push_back(program.Arenas.front()->make<FunctionAST>(
+        "void", Entry, std::vector<FuncArg>(), std::move(ScriptBody)));
+    endParse(program);
+    return program;
+}
+
+// --- STREAMING ---
+// One body at a time, in the order nextStreamedFunction() hands them out:
+// this file's functions, then the imported ones as their first caller is
+// parsed. Callers are not guaranteed to come after their callees, so the
+// streaming driver declares callees from FunctionInfo::Decl.
+static size_t StreamNext;
+static FunctionAST *StreamMain; // Generated main, whose body is already parsed
+static std::unordered_map<SymbolID, LazyFunction*> StreamImports;
+static std::deque<LazyFunction*> StreamQueue;
+
+static void demandStreamed(SymbolID Name, ModuleUnit *From) {
+    LazyFunction *Target = findImported(Name, From, StreamImports);
+    if (!Target || Target->Queued) return;
+    LazyFunction &LF = *Target;
+    LF.Queued = true;
+    FunctionRegistry.emplace(Name, LF.Module->Registry[Name]); // Helpers nobody imported by name
+    StreamQueue.push_back(&LF);
+}
+
+ProgramAST beginStream(Lexer &lexer) {
+    ProgramAST program = parseTopLevel(lexer);
+    diag() << TopLevelDiag;
+
+    StreamNext = 0;
+    StreamImports.clear();
+    StreamQueue.clear();
+    for (auto &M : ImportedUnits)
+        for (auto &LF : M->Functions) StreamImports.emplace(LF.Fn->getName(), &LF);
+    for (SymbolID Name : RootCalls) demandStreamed(Name, nullptr);
+
+    StreamMain = addGeneratedMain(program);
     return program;
-}
\ No newline at end of file
+}
+
+FunctionAST *nextStreamedFunction(ASTArena &Arena) {
+    DeferredBody *D;
+    if (StreamNext < MainBodies.size()) D = &MainBodies[StreamNext++];
+    else if (StreamMain) return std::exchange(StreamMain, nullptr);
+    else if (!StreamQueue.empty()) {
+        D = StreamQueue.front();
+        StreamQueue.pop_front();
+    } else return nullptr;
+
+    parseBody(*D, Arena);
+    diag() << D->Diagnostics;
+    std::string().swap(D->Diagnostics);
+    for (SymbolID Callee : D->Callees) demandStreamed(Callee, D->Module);
+    return D->Fn;
+}
+
+void endStream(ProgramAST &program) {
+    StreamMain = nullptr;
+    StreamImports.clear();
+    StreamQueue.clear();
+    endParse(program);
+}
+
+// --- LANGUAGE SERVER ---
+// quanta lsp keeps each file as top-level pieces and redoes only the ones an
+// edit touches. Pieces are found on raw tokens, with the same test the
+// parser uses for a function definition, so no AST is built to find them.
+std::vector<TopLevelPiece> splitTopLevel(std::string_view Source, size_t Begin, int Line,
+                                         llvm::function_ref<bool(size_t)> Resume) {
+    Lexer L(Source.substr(Begin), Line);
+    L.setQuiet(true); // Errors are reported when the piece is parsed
+
+    // Lookahead, each token with where the lexer stood after it
+    struct Lexed {
+        Token Tok;
+        size_t End;
+        int EndLine;
+    };
+    std::deque<Lexed> Ahead;
+    auto peek = [&](unsigned N) -> const Token & {
+        while (Ahead.size() <= N) {
+            Token T = L.next();
+            Ahead.push_back({T, Begin + L.getOffset(), L.getLine()});
+        }
+        return Ahead[N].Tok;
+    };
+
+    std::vector<TopLevelPiece> Pieces;
+    size_t End = Begin; // Just past the last token taken
+    int EndLine = Line;
+    auto take = [&] {
+        peek(0);
+        const Lexed &Next = Ahead.front();
+        TopLevelPiece &P = Pieces.back();
+        if (Next.Tok.type == TOK_IDENTIFIER) P.Identifiers.push_back(intern(Next.Tok.value));
+        else if (Next.Tok.type == TOK_IMPORT) P.HasImport = true;
+        End = Next.End;
+        EndLine = Next.EndLine;
+        int Type = Next.Tok.type;
+        Ahead.pop_front();
+        return Type;
+    };
+    auto finish = [&] {
+        Pieces.back().Horizon = Begin + L.getOffset();
+        std::vector<SymbolID> &Ids = Pieces.back().Identifiers;
+        std::sort(Ids.begin(), Ids.end());
+        Ids.erase(std::unique(Ids.begin(), Ids.end()), Ids.end());
+    };
+    auto functionAhead = [&] {
+        return startsFunctionDefinition([&](unsigned N) { return peek(N).type; });
+    };
+
+    int Depth = 0; // Braces open in the current script piece
+    while (peek(0).type != TOK_EOF) {
+        bool IsFunction = Depth == 0 && functionAhead();
+        if (IsFunction || Pieces.empty() || Pieces.back().IsFunction) {
+            if (!Pieces.empty()) {
+                finish();
+                if (Resume(End)) return Pieces;
+            }
+            TopLevelPiece P;
+            P.Begin = End;
+            P.Line = EndLine;
+            P.IsFunction = IsFunction;
+            if (IsFunction) {
+                const Token &Name = peek(peek(0).type == TOK_CONST ? 2 : 1);
+                P.Name = intern(Name.value);
+                P.NameOffset = (size_t)(Name.value.data() - Source.data()) - End;
+                P.NameLine = Name.line - EndLine;
+            }
+            Pieces.push_back(std::move(P));
+        }
+
+        if (!IsFunction) {
+            int T = take();
+            if (T == '{') Depth++;
+            else if (T == '}' && Depth > 0) Depth--;
+            continue;
+        }
+
+        // "type name(", the rest of the signature, then the body up to its
+        // matching '}'. A signature with no body ends at the next function.
+        take(); take(); take();
+        int Open = 0;
+        while (peek(0).type != TOK_EOF) {
+            if (Open == 0 && peek(0).type != '{' && functionAhead()) break;
+            int T = take();
+            if (T == '{') Open++;
+            else if (T == '}' && Open > 0 && --Open == 0) break;
+        }
+    }
+    if (!Pieces.empty()) finish();
+    return Pieces;
+}
+
+// A piece is parsed as parseTopLevel() would parse that stretch of the file,
+// except that a function body is parsed straight away and every function of
+// the file counts as known (the server keeps no definition order).
+FunctionAST *parsePiece(std::string_view Text, int Line, bool IsFunction, ASTArena &Arena,
+                        std::vector<ASTNode*> &Statements, std::ostream &Diag) {
+    Lexer lexer(Text, Line);
+    Parser P(lexer, Arena, &Diag);
+
+    if (IsFunction) {
+        FunctionAST *Fn = P.parseFunctionSignature();
+        if (!Fn) return nullptr;
+        Fn->Body = P.parseBlock();
+        return Fn;
+    }
+
+    while (P.getTok().type != TOK_EOF) {
+        if (P.getTok().type == TOK_IMPORT) {
+            P.parseImport();
+            continue;
+        }
+        auto stmt = P.parseStatement();
+        if (stmt) {
+            Statements.push_back(stmt);
+            if (P.getTok().type == ';') P.advance();
+        } else {
+            P.advance(); // Skip errors
+        }
+    }
+    return nullptr;
+}
+
+void loadImports(std::string_view Source, std::vector<std::unique_ptr<ASTArena>> &Arenas) {
+    LoadedModules.clear();
+    FunctionRegistry.clear();
+    resolveImports(scanImports(Lexer(Source)));
+    for (auto &M : ImportedUnits) Arenas.push_back(std::move(M->Arena));
+    ImportedUnits.clear();
+}
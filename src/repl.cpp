@@ -0,0 +1,151 @@
+#include "../include/quanta.h"
+#include "../include/quanta_compiler.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
+#include <deque>
+#include <iostream>
+
+// --- QUANTA REPL ---
+// One JIT session for the whole run. Each input (a statement, or a function
+// once its braces close) is parsed on top of the inputs before it, compiled
+// into a module of its own and emitted to an object in memory. That object
+// goes into a JITDylib of its own whose link order is every earlier input,
+// newest first, then the process and the runtime. So an input sees all
+// earlier functions and top-level variables, and defining a function again
+// replaces it for the inputs that follow (code compiled earlier keeps
+// calling the version it was linked against).
+// A failed input leaves nothing behind: its functions are unregistered and
+// its variables never become visible.
+
+// Open '{' minus closing '}', outside string and char literals and comments
+static int braceDepth(const std::string &Text) {
+    int Depth = 0;
+    char Quote = 0;
+    for (size_t i = 0; i < Text.size(); i++) {
+        char C = Text[i];
+        if (Quote) {
+            if (C == '\\') i++;
+            else if (C == Quote) Quote = 0;
+        } else if (C == '"' || C == '\'') {
+            Quote = C;
+        } else if (C == '@') {
+            i = Text.find('\n', i);
+            if (i == std::string::npos) break;
+        } else if (C == '{') {
+            Depth++;
+        } else if (C == '}') {
+            Depth--;
+        }
+    }
+    return Depth;
+}
+
+int runRepl(const std::vector<std::string> &Args) {
+    bool optimize = false;
+    for (const std::string &arg : Args) {
+        if (arg == "-O") {
+            optimize = true;
+        } else {
+            std::cerr << "Usage: quanta repl [-O]" << std::endl;
+            return 1;
+        }
+    }
+
+    // 1. Session
+    RootDir = "./";
+    initializeOperators();
+    initializeModule();
+    if (!initializeBackend()) return 1;
+    auto JIT = quanta::createJIT();
+    if (!JIT) {
+        std::cerr << "[Codegen Error] " << llvm::toString(JIT.takeError()) << std::endl;
+        return 1;
+    }
+    llvm::orc::ExecutionSession &ES = (*JIT)->getExecutionSession();
+    llvm::orc::JITDylibSearchOrder linkOrder = {
+        {&(*JIT)->getMainJITDylib(), llvm::orc::JITDylibLookupFlags::MatchExportedSymbolsOnly}};
+
+    // FunctionRegistry points into earlier inputs' ASTs, so they all stay
+    std::deque<std::string> sources;
+    std::vector<ProgramAST> programs;
+
+    bool interactive = llvm::sys::Process::StandardInIsUserInput();
+    if (interactive) std::cout << "Quanta REPL. Enter statements or functions; :quit to leave." << std::endl;
+
+    // 2. Read, compile, run
+    std::string input;
+    unsigned count = 0;
+    while (true) {
+        if (interactive) std::cout << (input.empty() ? "quanta> " : "   ...> ") << std::flush;
+        std::string line;
+        if (!std::getline(std::cin, line)) break;
+        if (input.empty() && (line == ":quit" || line == ":q")) break;
+        input += line + "\n";
+        if (braceDepth(input) > 0) continue;
+        if (input.find_first_not_of(" \t\r\n;") == std::string::npos) {
+            input.clear();
+            continue;
+        }
+
+        std::string name = "repl." + std::to_string(++count);
+        SymbolID entry = intern("__repl_" + std::to_string(count));
+        auto savedRegistry = FunctionRegistry;
+        auto savedModules = LoadedModules;
+        auto discard = [&] {
+            FunctionRegistry = std::move(savedRegistry);
+            LoadedModules = std::move(savedModules);
+        };
+
+        sources.push_back(std::move(input));
+        input.clear();
+        Lexer lexer(sources.back());
+        ProgramAST program = parseReplInput(lexer, entry);
+        if (HasError) {
+            discard();
+            continue;
+        }
+
+        beginReplInput(name);
+        for (FunctionAST *func : program.functions) {
+            llvm::Function *F = func->getName() == entry ? codegenReplEntry(func) : func->codegen();
+            if (!F) HasError = true;
+            else if (optimize) optimizeFunction(*F);
+        }
+        llvm::SmallVector<char, 0> object;
+        llvm::raw_svector_ostream objectStream(object);
+        if (HasError || !emitObject(objectStream)) {
+            discard();
+            continue;
+        }
+
+        // 3. Link it ahead of every earlier input
+        auto JD = ES.createJITDylib(name);
+        llvm::Error err = JD.takeError();
+        if (!err) {
+            JD->setLinkOrder(linkOrder);
+            err = (*JIT)->addObjectFile(*JD, llvm::MemoryBuffer::getMemBufferCopy(
+                                                 llvm::StringRef(object.data(), object.size()), name));
+        }
+        void (*run)() = nullptr;
+        if (!err) {
+            auto addr = (*JIT)->lookup(*JD, symbolName(entry));
+            if (addr) run = addr->toPtr<void (*)()>();
+            else err = addr.takeError();
+        }
+        if (err) {
+            std::cerr << "[Codegen Error] " << llvm::toString(std::move(err)) << std::endl;
+            discard();
+            continue;
+        }
+        linkOrder.insert(linkOrder.begin(), {&*JD, llvm::orc::JITDylibLookupFlags::MatchExportedSymbolsOnly});
+        commitReplInput();
+        programs.push_back(std::move(program));
+
+        run();
+        std::cout.flush();
+        fflush(nullptr);
+    }
+    if (interactive) std::cout << std::endl;
+    return 0;
+}
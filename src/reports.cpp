@@ -0,0 +1,328 @@
+#include "../include/quanta.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Object/SymbolSize.h"
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <set>
+
+extern std::unique_ptr<llvm::Module> TheModule;
+
+// ==========================================
+//  --stack-report
+// ==========================================
+bool StackReport = false;
+std::string StackUsageFile; // Set per compile by generateObjectCode()
+
+// Caller -> Callees, filled in by CallAST::codegen()
+static std::map<std::string, std::set<std::string>> CallGraph;
+
+void recordCallEdge(const std::string &Caller, const std::string &Callee) {
+    CallGraph[Caller].insert(Callee);
+}
+
+struct FrameInfo {
+    uint64_t Bytes = 0;
+    bool Dynamic = false;                     // Backend saw variable-sized objects
+    std::vector<std::string> DynamicAllocas;  // Allocas outside the entry block
+    std::set<std::string> ExternalCalls;      // Runtime/libc callees (frames unknown)
+};
+
+struct StackPath {
+    uint64_t Bytes = 0;
+    std::vector<std::string> Chain;
+    bool Recursive = false;
+    bool Unbounded = false;
+};
+
+// Lines look like "QuantaModule:main\t48\tstatic" (file:line:name when debug info exists)
+static std::map<std::string, FrameInfo> readFrameSizes() {
+    std::map<std::string, FrameInfo> Frames;
+    auto BufOrErr = llvm::MemoryBuffer::getFile(StackUsageFile);
+    if (!BufOrErr) {
+        std::cerr << "[Stack Report] Could not read backend stack usage file '" << StackUsageFile << "'" << std::endl;
+        return Frames;
+    }
+
+    llvm::StringRef Rest = (*BufOrErr)->getBuffer();
+    while (!Rest.empty()) {
+        llvm::StringRef Line;
+        std::tie(Line, Rest) = Rest.split('\n');
+        llvm::StringRef Where, Size, Kind;
+        std::tie(Where, Size) = Line.split('\t');
+        std::tie(Size, Kind) = Size.split('\t');
+        if (Size.empty()) continue;
+
+        std::string Name = Where.substr(Where.rfind(':') + 1).str();
+        FrameInfo &Info = Frames[Name];
+        Size.getAsInteger(10, Info.Bytes);
+        Info.Dynamic = Kind.trim() == "dynamic";
+    }
+    return Frames;
+}
+
+// Allocas the backend cannot fold into the fixed frame (declarations inside loops/ifs)
+static void scanModule(std::map<std::string, FrameInfo> &Frames) {
+    for (llvm::Function &F : *TheModule) {
+        if (F.isDeclaration()) continue;
+        FrameInfo &Info = Frames[F.getName().str()];
+
+        for (llvm::BasicBlock &BB : F) {
+            for (llvm::Instruction &I : BB) {
+                if (auto *AI = llvm::dyn_cast<llvm::AllocaInst>(&I)) {
+                    if (!AI->isStaticAlloca()) {
+                        Info.DynamicAllocas.push_back(AI->getName().str());
+                    }
+                }
+                else if (auto *CI = llvm::dyn_cast<llvm::CallInst>(&I)) {
+                    llvm::Function *Callee = CI->getCalledFunction();
+                    if (Callee && Callee->isDeclaration() && !Callee->isIntrinsic()) {
+                        Info.ExternalCalls.insert(Callee->getName().str());
+                    }
+                }
+            }
+        }
+    }
+}
+
+static StackPath worstPath(const std::string &Fn, std::map<std::string, FrameInfo> &Frames,
+                           std::map<std::string, StackPath> &Memo,
+                           std::vector<std::string> &Active,
+                           std::set<std::string> &RecursiveFns) {
+    // Back-edge: this function is already on the current call chain
+    for (const auto &A : Active) {
+        if (A == Fn) {
+            RecursiveFns.insert(Fn);
+            StackPath P;
+            P.Chain.push_back("[recursion into " + Fn + "]");
+            P.Recursive = true;
+            return P;
+        }
+    }
+    auto Cached = Memo.find(Fn);
+    if (Cached != Memo.end()) return Cached->second;
+
+    Active.push_back(Fn);
+    StackPath Deepest;
+    for (const auto &Callee : CallGraph[Fn]) {
+        StackPath Sub = worstPath(Callee, Frames, Memo, Active, RecursiveFns);
+        if (Sub.Recursive) Deepest.Recursive = true;
+        if (Sub.Unbounded) Deepest.Unbounded = true;
+        if (Sub.Bytes >= Deepest.Bytes) {
+            Deepest.Bytes = Sub.Bytes;
+            Deepest.Chain = Sub.Chain;
+        }
+    }
+    Active.pop_back();
+
+    const FrameInfo &Info = Frames[Fn];
+    StackPath P;
+    P.Bytes = Info.Bytes + Deepest.Bytes;
+    P.Chain.push_back(Fn);
+    P.Chain.insert(P.Chain.end(), Deepest.Chain.begin(), Deepest.Chain.end());
+    P.Recursive = Deepest.Recursive;
+    P.Unbounded = Deepest.Unbounded || Info.Dynamic || !Info.DynamicAllocas.empty();
+
+    Memo[Fn] = P;
+    return P;
+}
+
+void printStackReport() {
+    std::map<std::string, FrameInfo> Frames = readFrameSizes();
+    llvm::sys::fs::remove(StackUsageFile);
+    scanModule(Frames);
+
+    std::cout << "\n[Stack Report] Frame sizes from the backend (bytes):" << std::endl;
+    for (const auto &Entry : Frames) {
+        const FrameInfo &Info = Entry.second;
+        std::cout << "  " << std::left << std::setw(24) << Entry.first
+                  << std::right << std::setw(8) << Info.Bytes
+                  << (Info.Dynamic || !Info.DynamicAllocas.empty() ? "  dynamic" : "  static");
+        if (!CallGraph[Entry.first].empty()) {
+            std::cout << "  calls:";
+            for (const auto &Callee : CallGraph[Entry.first]) std::cout << " " << Callee;
+        }
+        std::cout << std::endl;
+    }
+
+    std::map<std::string, StackPath> Memo;
+    std::vector<std::string> Active;
+    std::set<std::string> RecursiveFns;
+    StackPath Worst = worstPath("main", Frames, Memo, Active, RecursiveFns);
+
+    std::cout << "[Stack Report] Worst-case stack depth from 'main': " << Worst.Bytes << " bytes";
+    if (Worst.Recursive || Worst.Unbounded) std::cout << " (NOT a guaranteed bound, see warnings)";
+    std::cout << std::endl << "  ";
+    for (size_t i = 0; i < Worst.Chain.size(); i++) {
+        if (i > 0) std::cout << " -> ";
+        auto It = Frames.find(Worst.Chain[i]);
+        std::cout << Worst.Chain[i];
+        if (It != Frames.end()) std::cout << " (" << It->second.Bytes << ")";
+    }
+    std::cout << std::endl;
+
+    // --- Warnings ---
+    for (const auto &Fn : RecursiveFns) {
+        std::cout << "\033[1;33m[Stack Report] Warning:\033[0m '" << Fn
+                  << "' is recursive; stack depth is unbounded." << std::endl;
+    }
+    for (const auto &Entry : Frames) {
+        for (const auto &Name : Entry.second.DynamicAllocas) {
+            std::cout << "\033[1;33m[Stack Report] Warning:\033[0m '" << Entry.first << "' allocates '" << Name
+                      << "' outside the entry block; it grows the stack every time it runs (e.g. inside a loop)." << std::endl;
+        }
+    }
+
+    std::set<std::string> External;
+    for (const auto &Entry : Frames) {
+        External.insert(Entry.second.ExternalCalls.begin(), Entry.second.ExternalCalls.end());
+    }
+    if (!External.empty()) {
+        std::cout << "[Stack Report] Note: frames of runtime/libc callees are not included:";
+        for (const auto &Name : External) std::cout << " " << Name;
+        std::cout << std::endl;
+    }
+}
+
+// ==========================================
+//  --size-report
+// ==========================================
+bool SizeReport = false;
+
+enum SizeCategory { CAT_QUANTA, CAT_RUNTIME, CAT_LIBC, CAT_COUNT };
+static const char *CategoryNames[CAT_COUNT] = {"Quanta", "Runtime", "libc/crt"};
+
+struct SectionSizes {
+    uint64_t Total = 0;
+    uint64_t ByCategory[CAT_COUNT] = {0, 0, 0};
+};
+
+void printSizeReport(const std::string &ImagePath) {
+    auto BinOrErr = llvm::object::ObjectFile::createObjectFile(ImagePath);
+    if (!BinOrErr) {
+        llvm::consumeError(BinOrErr.takeError());
+        std::cerr << "[Size Report] Could not read linked image '" << ImagePath << "'" << std::endl;
+        return;
+    }
+    llvm::object::ObjectFile &Obj = *BinOrErr->getBinary();
+
+    // Functions this program defined (anything else in the image came from a library)
+    std::set<std::string> QuantaFns;
+    for (llvm::Function &F : *TheModule) {
+        if (!F.isDeclaration()) QuantaFns.insert(F.getName().str());
+    }
+
+    // --- 1. Sections ---
+    std::vector<std::string> SectionOrder;
+    std::map<std::string, SectionSizes> Sections;
+    for (const llvm::object::SectionRef &Sec : Obj.sections()) {
+        auto NameOrErr = Sec.getName();
+        if (!NameOrErr) { llvm::consumeError(NameOrErr.takeError()); continue; }
+        std::string Name = NameOrErr->str();
+        if (Name.empty() || Sec.getSize() == 0) continue;
+        if (Sections.find(Name) == Sections.end()) SectionOrder.push_back(Name);
+        Sections[Name].Total += Sec.getSize();
+    }
+
+    // --- 2. Symbols ---
+    std::map<std::string, uint64_t> Symbols[CAT_COUNT];
+    std::set<std::string> Imports;
+    std::string CurrentFile; // ELF lists a FILE symbol before each file's local symbols
+    for (const auto &Entry : llvm::object::computeSymbolSizes(Obj)) {
+        const llvm::object::SymbolRef &Sym = Entry.first;
+        auto NameOrErr = Sym.getName();
+        auto FlagsOrErr = Sym.getFlags();
+        if (!NameOrErr || !FlagsOrErr) {
+            if (!NameOrErr) llvm::consumeError(NameOrErr.takeError());
+            if (!FlagsOrErr) llvm::consumeError(FlagsOrErr.takeError());
+            continue;
+        }
+        std::string Name = NameOrErr->str();
+        if (Obj.isMachO() && !Name.empty() && Name[0] == '_') Name = Name.substr(1);
+        if (Name.empty()) continue;
+
+        if (*FlagsOrErr & llvm::object::SymbolRef::SF_Undefined) {
+            Imports.insert(Name.substr(0, Name.find('@')));
+            continue;
+        }
+        auto TypeOrErr = Sym.getType();
+        if (TypeOrErr && *TypeOrErr == llvm::object::SymbolRef::ST_File) {
+            CurrentFile = Name;
+            continue;
+        }
+        if (!TypeOrErr) llvm::consumeError(TypeOrErr.takeError());
+        bool IsLocal = !(*FlagsOrErr & llvm::object::SymbolRef::SF_Global);
+
+        auto SecOrErr = Sym.getSection();
+        if (!SecOrErr) { llvm::consumeError(SecOrErr.takeError()); continue; }
+        if (*SecOrErr == Obj.section_end()) continue;
+        auto SecNameOrErr = (*SecOrErr)->getName();
+        if (!SecNameOrErr) { llvm::consumeError(SecNameOrErr.takeError()); continue; }
+
+        SizeCategory Cat = CAT_LIBC;
+        if (QuantaFns.count(Name)) Cat = CAT_QUANTA;
+        else if (Name.rfind("quanta_", 0) == 0) Cat = CAT_RUNTIME;
+        else if (IsLocal && CurrentFile.find("quanta_lib") != std::string::npos) Cat = CAT_RUNTIME;
+
+        Symbols[Cat][Name] += Entry.second;
+        auto It = Sections.find(SecNameOrErr->str());
+        if (It != Sections.end()) It->second.ByCategory[Cat] += Entry.second;
+    }
+
+    // --- 3. Pooled string literals (private globals, they have no symbol in the image) ---
+    uint64_t PoolBytes = 0;
+    unsigned PoolCount = 0;
+    const llvm::DataLayout &DL = TheModule->getDataLayout();
+    for (llvm::GlobalVariable &GV : TheModule->globals()) {
+        if (GV.hasInitializer() && llvm::isa<llvm::ConstantDataArray>(GV.getInitializer())) {
+            PoolBytes += DL.getTypeAllocSize(GV.getValueType());
+            PoolCount++;
+        }
+    }
+
+    // --- 4. Print ---
+    std::cout << "\n[Size Report] Image '" << ImagePath << "' by section (bytes):" << std::endl;
+    std::cout << "  " << std::left << std::setw(22) << "Section" << std::right << std::setw(10) << "Total";
+    for (int c = 0; c < CAT_COUNT; c++) std::cout << std::setw(10) << CategoryNames[c];
+    std::cout << std::setw(14) << "Unattributed" << std::endl;
+
+    uint64_t ImageTotal = 0;
+    for (const auto &Name : SectionOrder) {
+        const SectionSizes &S = Sections[Name];
+        uint64_t Attributed = 0;
+        std::cout << "  " << std::left << std::setw(22) << Name << std::right << std::setw(10) << S.Total;
+        for (int c = 0; c < CAT_COUNT; c++) {
+            std::cout << std::setw(10) << S.ByCategory[c];
+            Attributed += S.ByCategory[c];
+        }
+        std::cout << std::setw(14) << (S.Total > Attributed ? S.Total - Attributed : 0) << std::endl;
+        ImageTotal += S.Total;
+    }
+    std::cout << "  " << std::left << std::setw(22) << "TOTAL" << std::right << std::setw(10) << ImageTotal << std::endl;
+
+    for (int c = 0; c < CAT_COUNT; c++) {
+        if (Symbols[c].empty()) continue;
+        uint64_t Sum = 0;
+        for (const auto &Sym : Symbols[c]) Sum += Sym.second;
+        std::cout << "[Size Report] " << CategoryNames[c] << " symbols: " << Sum << " bytes" << std::endl;
+        for (const auto &Sym : Symbols[c]) {
+            if (Sym.second == 0) continue;
+            std::cout << "  " << std::left << std::setw(32) << Sym.first << std::right << std::setw(8) << Sym.second << std::endl;
+        }
+    }
+
+    std::cout << "[Size Report] Pooled string literals: " << PoolCount << " (" << PoolBytes
+              << " bytes, read-only data)" << std::endl;
+
+    if (!Imports.empty()) {
+        std::cout << "[Size Report] Resolved at load time (shared libc, not in this image):";
+        for (const auto &Name : Imports) std::cout << " " << Name;
+        std::cout << std::endl;
+    }
+}
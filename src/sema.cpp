@@ -0,0 +1,256 @@
+#include "../include/quanta.h"
+#include <algorithm>
+#include <cstdlib>
+
+// --- TYPE ANNOTATION ---
+// One walk over a function body, just before codegen, that gives every node
+// the type codegen will store its value in. It follows codegen's rules
+// (literal widths, declared storage, signatures, promotion) and tracks
+// variables through the same scopes as codegen's NamedValues, so shadowing,
+// redeclaration and assignment-declared variables agree. Nothing is
+// reported here: a node that cannot be typed stays Unknown and codegen
+// reports it as before.
+
+// --- 1. SPELLINGS ---
+
+QType variableType(const std::string &Type, int Bytes) {
+    if (Type == "bool" || Type == "char") return QType::integer(8);
+    if (Type.find("int") != std::string::npos) return QType::integer(Bytes * 8);
+    if (Type.find("float") != std::string::npos) return QType::floating(Bytes == 4 ? 32 : 64);
+    if (Type == "string") return QType::string();
+    return QType::integer(32);
+}
+
+QType parameterType(const std::string &Type) {
+    if (Type == "float") return QType::floating(32);
+    if (Type == "double") return QType::floating(64);
+    if (Type == "string") return QType::string();
+    if (Type == "int8") return QType::integer(8);
+    return QType::integer(32); // "int" and anything unknown
+}
+
+QType returnType(const std::string &Type) {
+    if (Type == "string") return QType::string();
+    if (Type == "void") return {QType::Void};
+    if (Type == "float") return QType::floating(32);
+    if (Type == "double") return QType::floating(64);
+    if (Type.find("int") == 0 && Type.size() > 3) {
+        int Bits = std::atoi(Type.c_str() + 3); // int8, int64, ...
+        if (Bits > 0) return QType::integer(Bits);
+    }
+    return QType::integer(32);
+}
+
+QType elementType(const std::string &Type) {
+    if (Type == "float") return QType::floating(64);
+    if (Type == "string") return QType::string();
+    if (Type == "bool" || Type == "char") return QType::integer(8);
+    return QType::integer(32);
+}
+
+QType arithmeticType(QType L, QType R) {
+    if (!L.isNumber() || !R.isNumber()) return {};
+    // Any float makes it float arithmetic, at the widest float's width
+    if (L.Kind == QType::Float || R.Kind == QType::Float) {
+        unsigned Bits = 0;
+        if (L.Kind == QType::Float) Bits = L.Bits;
+        if (R.Kind == QType::Float && R.Bits > Bits) Bits = R.Bits;
+        return QType::floating(Bits);
+    }
+    return QType::integer(std::max(L.Bits, R.Bits));
+}
+
+// --- 2. THE PASS ---
+
+namespace {
+
+bool isComparison(char Op) {
+    return Op == '<' || Op == '>' || Op == TOK_EQ || Op == TOK_NEQ || Op == TOK_LEQ || Op == TOK_GEQ;
+}
+
+class TypeAnnotator : public ASTVisitor<TypeAnnotator, QType> {
+    ScopedSymbolTable<QType> Vars;
+
+    QType annotate(ASTNode *N) { return N ? (N->Ty = visit(N)) : QType(); }
+    QType variable(SymbolID Name) {
+        QType *T = Vars.lookup(Name);
+        return T ? *T : QType();
+    }
+
+public:
+    void run(FunctionAST *F, llvm::ArrayRef<std::pair<SymbolID, QType>> Outer) {
+        for (auto &[Name, T] : Outer) Vars.declare(Name, T);
+        for (const FuncArg &Arg : F->Args) Vars.declare(Arg.Name, parameterType(Arg.Type));
+        for (ASTNode *Stmt : F->Body) annotate(Stmt);
+    }
+
+    // Anything without a rule below: type the children, the node has none
+    QType visitNode(ASTNode *N) {
+        forEachChild(N, [this](ASTNode *&Child) { annotate(Child); });
+        return {};
+    }
+
+    // --- Values ---
+    QType visitNumber(NumberAST *N) { return QType::integer(N->Bits); }
+    QType visitFloat(FloatAST *) { return QType::floating(64); }
+    QType visitBool(BoolAST *) { return QType::integer(1); }
+    QType visitChar(CharAST *) { return QType::integer(8); }
+    QType visitString(StringAST *) { return QType::string(); }
+
+    // --- Variables ---
+    QType visitVariable(VariableAST *N) { return variable(N->Name); }
+
+    QType visitVarDecl(VarDeclAST *N) {
+        annotate(N->InitVal);
+        QType T = variableType(N->Type, N->Bytes);
+        Vars.declare(N->Name, T);
+        return T;
+    }
+
+    QType visitAssignment(AssignmentAST *N) {
+        QType Value = annotate(N->RHS);
+        if (QType *Existing = Vars.lookup(N->Name)) return *Existing;
+        // First assignment declares it, with the value's own type
+        Vars.declare(N->Name, Value);
+        return Value;
+    }
+
+    QType visitUpdateExpr(UpdateExprAST *N) { return variable(N->Name); }
+    QType visitByteSize(ByteSizeAST *) { return QType::integer(64); }
+    QType visitTypeof(TypeofAST *) { return QType::string(); }
+
+    QType visitFixedStringDecl(FixedStringDeclAST *N) {
+        annotate(N->InitValue);
+        Vars.declare(N->VarName, QType::string());
+        return QType::string();
+    }
+
+    QType visitFixedArrayDecl(FixedArrayDeclAST *N) {
+        annotate(N->InitValue);
+        QType T = QType::container(QType::Array, elementType(N->TypeName));
+        Vars.declare(N->VarName, T);
+        return T;
+    }
+
+    QType visitDynamicListDecl(DynamicListDeclAST *N) {
+        annotate(N->InitValue);
+        QType T = QType::container(QType::List, elementType(N->TypeName));
+        Vars.declare(N->VarName, T);
+        return T;
+    }
+
+    QType visitIndexAssign(IndexAssignAST *N) {
+        QType Obj = annotate(N->Obj);
+        annotate(N->Index);
+        QType Value = annotate(N->Value);
+        // A character written into a string is stored as one byte
+        if (Obj.Kind == QType::String && Value.Kind == QType::Int) return QType::integer(8);
+        return Value;
+    }
+
+    // --- Expressions ---
+    QType visitBinaryExpr(BinaryExprAST *N) {
+        QType L = annotate(N->LHS), R = annotate(N->RHS);
+        if (L.Kind == QType::String && R.Kind == QType::String) {
+            if (N->Op == '+') return QType::string();
+            return isComparison(N->Op) ? QType::integer(32) : QType();
+        }
+        QType Operands = arithmeticType(L, R);
+        if (Operands.Kind == QType::Unknown) return {};
+        if (isComparison(N->Op)) return QType::integer(32);
+        switch (N->Op) {
+        case '+': case '-': case '*': case '/': case '%': return Operands;
+        default: return {};
+        }
+    }
+
+    QType visitPrint(PrintAST *N) {
+        for (ASTNode *Arg : N->Args) annotate(Arg);
+        return QType::integer(32);
+    }
+
+    QType visitCall(CallAST *N) {
+        for (CallArg &Arg : N->Args) annotate(Arg.Val);
+        auto It = FunctionRegistry.find(N->Callee);
+        if (It == FunctionRegistry.end()) return {};
+        // Defaults are generated at the call, in the caller's scope
+        for (ArgInfo &Arg : It->second.Args) annotate(Arg.DefaultValue);
+        return It->second.Decl ? returnType(It->second.Decl->ReturnType) : QType();
+    }
+
+    QType visitStringIndex(StringIndexAST *N) {
+        QType Base = annotate(N->BaseExpr);
+        annotate(N->IndexExpr);
+        if (Base.Kind == QType::Array || Base.Kind == QType::List) return Base.element();
+        return Base.Kind == QType::String ? QType::integer(8) : QType();
+    }
+
+    QType visitStringSlice(StringSliceAST *N) {
+        visitNode(N);
+        return QType::string();
+    }
+
+    QType visitMethodCall(MethodCallAST *N) {
+        QType Obj = annotate(N->Obj);
+        for (ASTNode *Arg : N->Args) annotate(Arg);
+
+        if (Obj.Kind == QType::List) {
+            switch (N->MethodName) {
+            case SYM_PUSH: case SYM_CLEAR: return QType::floating(64); // No value, as 0.0
+            case SYM_POP: return Obj.element();
+            case SYM_LEN: return QType::integer(32);
+            default: return {};
+            }
+        }
+        if (Obj.Kind != QType::String) return {};
+        switch (N->MethodName) {
+        case SYM_LEN:
+        case SYM_ISUPPER: case SYM_ISLOWER: case SYM_ISALPHA:
+        case SYM_ISDIGIT: case SYM_ISSPACE: case SYM_ISALNUM:
+        case SYM_FIND: case SYM_COUNT: case SYM_STARTSWITH: case SYM_ENDSWITH:
+            return QType::integer(32);
+        case SYM_UPPER: case SYM_LOWER: case SYM_REVERSE: case SYM_STRIP:
+        case SYM_LSTRIP: case SYM_RSTRIP: case SYM_CAPITALIZE: case SYM_TITLE:
+        case SYM_REPLACE:
+            return QType::string();
+        default:
+            return {};
+        }
+    }
+
+    // --- Control flow ---
+    QType visitBlock(BlockAST *N) {
+        ScopedSymbolTable<QType>::Scope Scope(Vars);
+        for (ASTNode *Stmt : N->Statements) annotate(Stmt);
+        return {QType::Void};
+    }
+
+    QType visitLoopOverString(LoopOverStringAST *N) {
+        annotate(N->StringExpr);
+        ScopedSymbolTable<QType>::Scope Scope(Vars);
+        Vars.declare(N->VarName, QType::integer(32));
+        annotate(N->Body);
+        return {QType::Void};
+    }
+
+    QType visitIfExpr(IfExprAST *N) {
+        visitNode(N);
+        return {QType::Void};
+    }
+
+    QType visitLoop(LoopAST *N) {
+        visitNode(N);
+        return {QType::Void};
+    }
+
+    QType visitReturn(ReturnAST *N) {
+        visitNode(N);
+        return {QType::Void};
+    }
+};
+
+} // namespace
+
+void annotateTypes(FunctionAST *F, llvm::ArrayRef<std::pair<SymbolID, QType>> Outer) {
+    TypeAnnotator().run(F, Outer);
+}
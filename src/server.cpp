@@ -0,0 +1,125 @@
+#include "../include/quanta.h"
+#include <iostream>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include "../include/quanta_server.h"
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+// --- COMPILE SERVER ---
+// Startup is paid once: the host backend and its TargetMachine are set up
+// and the runtime is compiled to an object before the first request. Every
+// request then runs in a fork of that warm process, so a failing compile
+// cannot take the server down and requests do not share compiler state.
+
+#ifdef _WIN32
+int runServer(const std::string &SocketPath) {
+    std::cerr << "Error: --server needs Unix domain sockets and is not available on Windows" << std::endl;
+    return 1;
+}
+#else
+
+static bool readAll(int Fd, void *Buf, size_t Size) {
+    char *P = static_cast<char*>(Buf);
+    while (Size) {
+        ssize_t N = read(Fd, P, Size);
+        if (N < 0 && errno == EINTR) continue;
+        if (N <= 0) return false;
+        P += N;
+        Size -= N;
+    }
+    return true;
+}
+
+// Child side: take over the client's stdio and working directory, run the
+// command line, report its status.
+static int serveRequest(int Conn) {
+    RequestHeader Header;
+    int Fds[3];
+    char Control[CMSG_SPACE(sizeof(Fds))];
+    iovec IOV{&Header, sizeof(Header)};
+    msghdr Msg{};
+    Msg.msg_iov = &IOV;
+    Msg.msg_iovlen = 1;
+    Msg.msg_control = Control;
+    Msg.msg_controllen = sizeof(Control);
+
+    if (recvmsg(Conn, &Msg, MSG_WAITALL) != (ssize_t)sizeof(Header)) return 1;
+    cmsghdr *C = CMSG_FIRSTHDR(&Msg);
+    if (!C || C->cmsg_type != SCM_RIGHTS || C->cmsg_len != CMSG_LEN(sizeof(Fds))) return 1;
+    std::memcpy(Fds, CMSG_DATA(C), sizeof(Fds));
+
+    std::string Payload(Header.Length, '\0');
+    if (!readAll(Conn, &Payload[0], Payload.size())) return 1;
+
+    // Working directory, then the arguments
+    std::vector<std::string> Fields;
+    for (size_t Start = 0, End; Start < Payload.size(); Start = End + 1) {
+        End = Payload.find('\0', Start);
+        if (End == std::string::npos) End = Payload.size();
+        Fields.push_back(Payload.substr(Start, End - Start));
+    }
+    if (Fields.empty() || chdir(Fields[0].c_str()) != 0) return 1;
+
+    for (int I = 0; I < 3; I++) {
+        dup2(Fds[I], I);
+        close(Fds[I]);
+    }
+
+    int32_t Status = runQuanta(std::vector<std::string>(Fields.begin() + 1, Fields.end()));
+    std::cout.flush();
+    std::cerr.flush();
+    fflush(nullptr);
+    return write(Conn, &Status, sizeof(Status)) == (ssize_t)sizeof(Status) ? 0 : 1;
+}
+
+int runServer(const std::string &SocketPath) {
+    std::string Path = SocketPath.empty() ? defaultServerSocket() : SocketPath;
+
+    // 1. Warm up
+    if (!initializeBackend()) return 1;
+    prebuildRuntime(Path + ".quanta_lib.o");
+
+    // 2. Listen
+    sockaddr_un Addr{};
+    Addr.sun_family = AF_UNIX;
+    if (Path.size() >= sizeof(Addr.sun_path)) {
+        std::cerr << "Error: Socket path too long: " << Path << std::endl;
+        return 1;
+    }
+    std::strcpy(Addr.sun_path, Path.c_str());
+
+    int Listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(Path.c_str());
+    if (Listener < 0 || bind(Listener, (sockaddr*)&Addr, sizeof(Addr)) != 0 || listen(Listener, 64) != 0) {
+        std::cerr << "Error: Could not listen on " << Path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    signal(SIGCHLD, SIG_IGN); // Finished requests are reaped automatically
+    std::cout << "[INFO] Quanta server listening on " << Path << std::endl;
+
+    // 3. One fork per request
+    while (true) {
+        int Conn = accept(Listener, nullptr, nullptr);
+        if (Conn < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Error: accept failed: " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+
+        pid_t Pid = fork();
+        if (Pid == 0) {
+            close(Listener);
+            signal(SIGCHLD, SIG_DFL); // system() has to wait for its children
+            _exit(serveRequest(Conn));
+        }
+        if (Pid < 0) std::cerr << "Error: fork failed: " << std::strerror(errno) << std::endl;
+        close(Conn);
+    }
+}
+#endif
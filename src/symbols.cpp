@@ -0,0 +1,55 @@
+#include "../include/quanta.h"
+#include <deque>
+#include <mutex>
+
+// --- SYMBOL TABLE (String Interner) ---
+// Must match the order of the KnownSymbol enum in quanta.h
+static const char *const KnownNames[] = {
+    "", "main", "print", "input", "delay", "type", "bytesize", "all",
+    "push", "pop", "len", "clear",
+    "upper", "lower", "reverse", "strip", "lstrip", "rstrip",
+    "capitalize", "title", "isupper", "islower", "isalpha",
+    "isdigit", "isspace", "isalnum", "find", "count",
+    "startswith", "endswith", "replace",
+};
+static_assert(sizeof(KnownNames) / sizeof(KnownNames[0]) == SYM_FIRST_USER,
+              "KnownNames is out of sync with KnownSymbol");
+
+// Names live in a deque so references handed out by symbolName() stay valid,
+// and the lookup keys are views into those same strings. Imported modules are
+// parsed concurrently, so every access goes through the lock.
+struct SymbolTable {
+    std::mutex Lock;
+    std::deque<std::string> Names;
+    std::unordered_map<std::string_view, SymbolID> IDs;
+
+    SymbolTable() {
+        for (const char *Name : KnownNames) add(Name);
+    }
+
+    SymbolID add(std::string_view Name) {
+        SymbolID ID = (SymbolID)Names.size();
+        Names.emplace_back(Name);
+        IDs.emplace(Names.back(), ID);
+        return ID;
+    }
+};
+
+static SymbolTable &symbols() {
+    static SymbolTable Table;
+    return Table;
+}
+
+SymbolID intern(std::string_view Name) {
+    SymbolTable &Table = symbols();
+    std::lock_guard<std::mutex> Guard(Table.Lock);
+    auto It = Table.IDs.find(Name);
+    if (It != Table.IDs.end()) return It->second;
+    return Table.add(Name);
+}
+
+const std::string &symbolName(SymbolID ID) {
+    SymbolTable &Table = symbols();
+    std::lock_guard<std::mutex> Guard(Table.Lock);
+    return Table.Names[ID];
+}